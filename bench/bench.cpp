@@ -0,0 +1,419 @@
+// qtcsv_bench：解析、加载、保存、查找与流式读取的微基准，结果以 JSON 输出
+// 每项基准重复运行若干次，报告最快一次的吞吐量（MB/s、cells/s）、平均每次的内存分配次数和峰值常驻内存。
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <vector>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include "QCsv.hpp"
+#include "QCsvSimd.hpp"
+#include "QCsvWriter.hpp"
+#include "generator.hpp"
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+// ==================== 内存分配计数 ====================
+
+namespace {
+std::atomic<quint64> allocationCount{0};
+}
+
+#if defined(__GLIBC__)
+// glibc 下替换 malloc 系列，Qt 容器直接调用 malloc，只替换 operator new 会漏掉大部分分配
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept {
+    __libc_free(ptr);
+}
+}
+#else
+// 其他平台只统计 operator new
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
+namespace {
+
+// ==================== 峰值常驻内存 ====================
+
+// Linux 上每项基准开始前清零 VmHWM，其他平台报告进程启动以来的峰值
+void resetPeakRss() {
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/clear_refs");
+    if (file.open(QIODevice::WriteOnly)) file.write("5");
+#endif
+}
+
+// 峰值常驻内存（KB）
+qint64 peakRssKb() {
+#if defined(Q_OS_LINUX)
+    QFile file("/proc/self/status");
+    if (file.open(QIODevice::ReadOnly)) {
+        for (const QByteArray& line : file.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+    return -1;
+#elif defined(Q_OS_UNIX)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss / 1024;  // macOS 以字节为单位
+#else
+    return usage.ru_maxrss;
+#endif
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters {};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+#else
+    return -1;
+#endif
+}
+
+// ==================== 基准运行 ====================
+
+// 丢弃写入数据的设备，写入基准只测编码与缓冲
+class NullDevice : public QIODevice {
+public:
+    NullDevice() { open(QIODevice::WriteOnly); }
+
+protected:
+    qint64 readData(char*, qint64) override { return -1; }
+    qint64 writeData(const char*, qint64 size) override { return size; }
+};
+
+class BenchRunner {
+public:
+    BenchRunner(int repeat, const QString& filter) : repeat(repeat), filter(filter) {}
+
+    // setup 在每次计时前执行，不计入时间和分配次数；bytes、cells 为每次运行处理的数据量
+    template<typename Setup, typename Body>
+    void run(const QString& name, qint64 bytes, qint64 cells, Setup&& setup, Body&& body) {
+        if (!filter.isEmpty() && !name.contains(filter)) return;
+
+        double best = 0;
+        double total = 0;
+        quint64 allocations = 0;
+        resetPeakRss();
+        for (int i = 0; i < repeat; ++i) {
+            setup();
+            const quint64 before = allocationCount.load(std::memory_order_relaxed);
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            const double seconds = timer.nsecsElapsed() / 1e9;
+            allocations += allocationCount.load(std::memory_order_relaxed) - before;
+            total += seconds;
+            if (i == 0 || seconds < best) best = seconds;
+        }
+
+        QJsonObject result;
+        result.insert("name", name);
+        result.insert("iterations", repeat);
+        result.insert("bytes", bytes);
+        result.insert("cells", cells);
+        result.insert("best_seconds", best);
+        result.insert("mean_seconds", total / repeat);
+        result.insert("mb_per_s", best > 0 ? bytes / best / 1e6 : 0.0);
+        result.insert("cells_per_s", best > 0 ? cells / best : 0.0);
+        result.insert("allocations", static_cast<qint64>(allocations / repeat));
+        result.insert("peak_rss_kb", peakRssKb());
+        results.append(result);
+        qInfo().noquote() << name << QString::number(best * 1000, 'f', 2) << "ms";
+    }
+
+    template<typename Body>
+    void run(const QString& name, qint64 bytes, qint64 cells, Body&& body) {
+        run(name, bytes, cells, [] {}, std::forward<Body>(body));
+    }
+
+    QJsonArray results;
+
+private:
+    int repeat;
+    QString filter;
+};
+
+// 防止基准结果被优化掉
+volatile qint64 sink = 0;
+
+QCsv::LoadOptions baseOptions() {
+    QCsv::LoadOptions options;
+    options.buildSearchIndex = false;
+    return options;
+}
+
+std::unique_ptr<QCsv> loadCsv(const QString& path, const QCsv::LoadOptions& options) {
+    auto csv = std::make_unique<QCsv>(path);
+    csv->setLoadOptions(options);
+    csv->load();
+    return csv;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("QtCsv microbenchmarks");
+    parser.addHelpOption();
+    const QCommandLineOption rowsOption("rows", "Generated rows.", "n", "200000");
+    const QCommandLineOption columnsOption("columns", "Generated columns.", "n", "10");
+    const QCommandLineOption quoteOption("quotes", "Ratio of quoted text fields.", "ratio", "0.1");
+    const QCommandLineOption utf8Option("utf8", "Ratio of text fields with multibyte UTF-8.", "ratio", "0.2");
+    const QCommandLineOption numericOption("numeric", "Ratio of numeric columns.", "ratio", "0.5");
+    const QCommandLineOption seedOption("seed", "Generator seed.", "n", "1");
+    const QCommandLineOption repeatOption("repeat", "Runs per benchmark.", "n", "5");
+    const QCommandLineOption filterOption("filter", "Only run benchmarks whose name contains this text.", "text");
+    const QCommandLineOption outputOption("output", "Write the JSON report to this file instead of stdout.", "file");
+    parser.addOptions({ rowsOption, columnsOption, quoteOption, utf8Option, numericOption,
+                        seedOption, repeatOption, filterOption, outputOption });
+    parser.process(app);
+
+    CsvGeneratorOptions generator;
+    generator.rows = std::max(1, parser.value(rowsOption).toInt());
+    generator.columns = std::max(1, parser.value(columnsOption).toInt());
+    generator.quoteRatio = parser.value(quoteOption).toDouble();
+    generator.utf8Ratio = parser.value(utf8Option).toDouble();
+    generator.numericRatio = parser.value(numericOption).toDouble();
+    generator.seed = parser.value(seedOption).toULongLong();
+    const int repeat = std::max(1, parser.value(repeatOption).toInt());
+
+    const QByteArray data = generateCsv(generator);
+    const qint64 bytes = data.size();
+    const qint64 cells = static_cast<qint64>(generator.rows) * generator.columns;
+    const QString path = QDir(QDir::tempPath()).filePath("qtcsv_bench_input.csv");
+    const QString outPath = QDir(QDir::tempPath()).filePath("qtcsv_bench_output.csv");
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(data) != bytes) {
+            qCritical() << "Could not write" << path;
+            return 1;
+        }
+    }
+
+    BenchRunner bench(repeat, parser.value(filterOption));
+
+    // ---------- 解析器 ----------
+    std::unique_ptr<CsvStorage> storage;
+    auto freshStorage = [&storage] { storage = std::make_unique<CsvStorage>(); };
+    bench.run("parse/utf8", bytes, cells, freshStorage, [&] {
+        Utf8CsvParser utf8(*storage, generator.separator);
+        utf8.parse(data.constData(), static_cast<size_t>(bytes), true);
+        sink = utf8.getStatistics().totalCells;
+    });
+    QMultiMap<QString, quint64> searchModel;
+    bench.run("parse/legacy", bytes, cells, [&] { freshStorage(); searchModel.clear(); }, [&] {
+        CsvParser legacy(*storage, searchModel, generator.separator);
+        legacy.parse(data.constData(), static_cast<size_t>(bytes), true);
+        sink = legacy.getStatistics().totalCells;
+    });
+    storage.reset();
+    searchModel.clear();
+
+    // ---------- load() ----------
+    std::unique_ptr<QCsv> loaded;
+    auto benchLoad = [&](const QString& name, const QCsv::LoadOptions& options) {
+        bench.run(name, bytes, cells, [&] { loaded = std::make_unique<QCsv>(path); loaded->setLoadOptions(options); },
+                  [&] { loaded->load(); });
+        loaded.reset();
+    };
+    QCsv::LoadOptions options = baseOptions();
+    benchLoad("load/serial", options);
+    options.memoryMap = true;
+    benchLoad("load/mmap", options);
+    options.deferDecode = true;
+    benchLoad("load/mmap_defer", options);
+    options = baseOptions();
+    options.parallel = true;
+    options.parallelThreshold = 0;
+    benchLoad("load/parallel", options);
+    options = baseOptions();
+    options.lazy = true;
+    benchLoad("load/lazy", options);
+    options = baseOptions();
+    options.buildSearchIndex = true;
+    benchLoad("load/with_index", options);
+    options = baseOptions();
+    options.utf8Storage = true;
+    benchLoad("load/utf8_storage", options);
+
+    // ---------- 写入 ----------
+    std::unique_ptr<QCsv> csv = loadCsv(path, baseOptions());
+    const int rowCount = csv->getRowCount();
+    const int columnCount = csv->getColumnCount();
+    bench.run("save/saveAs", bytes, cells, [&] { csv->saveAs(outPath); });
+    QFile::remove(outPath);
+    {
+        QCsv::LoadOptions utf8 = baseOptions();
+        utf8.utf8Storage = true;
+        std::unique_ptr<QCsv> native = loadCsv(path, utf8);
+        bench.run("save/saveAs_utf8", bytes, cells, [&] { native->saveAs(outPath); });
+        QFile::remove(outPath);
+    }
+
+    std::vector<QString> values;
+    values.reserve(static_cast<size_t>(cells));
+    for (int row = 1; row <= rowCount; ++row) {
+        for (int col = 1; col <= columnCount; ++col) {
+            values.push_back(csv->getValue(row, col));
+        }
+    }
+    bench.run("write/CsvWriter", bytes, cells, [&] {
+        NullDevice device;
+        CsvWriter writer(device, generator.separator);
+        size_t index = 0;
+        for (int row = 0; row < rowCount; ++row) {
+            for (int col = 0; col < columnCount; ++col) {
+                if (col > 0) writer.writeSeparator();
+                writer.writeField(values[index++]);
+            }
+            writer.endRow();
+        }
+        writer.flush();
+        sink = writer.bytesWritten();
+    });
+
+    // ---------- 单元格读写 ----------
+    const int LOOKUPS = 1000000;
+    std::vector<std::pair<int, int>> positions(LOOKUPS);
+    SplitMix64 random(generator.seed);
+    for (auto& [row, col] : positions) {
+        row = 1 + static_cast<int>(random.bounded(rowCount));
+        col = 1 + static_cast<int>(random.bounded(columnCount));
+    }
+    bench.run("cell/getValue", 0, LOOKUPS, [&] {
+        qint64 length = 0;
+        for (const auto& [row, col] : positions) {
+            length += csv->getValue(row, col).size();
+        }
+        sink = length;
+    });
+    const QString replacement = QStringLiteral("replacement");
+    bench.run("cell/setValue", 0, LOOKUPS, [&] {
+        for (const auto& [row, col] : positions) {
+            csv->setValue(row, col, replacement);
+        }
+    });
+
+    // ---------- 查找 ----------
+    const int QUERIES = 1000;
+    QStringList queries;
+    QStringList prefixes;
+    for (int i = 0; i < QUERIES; ++i) {
+        const qint64 index = static_cast<qint64>(random.bounded(values.size()));
+        queries.append(values[index]);
+        prefixes.append(values[index].left(2));
+    }
+    csv = loadCsv(path, baseOptions());
+    bench.run("search/build_index", bytes, cells, [&] { csv = loadCsv(path, baseOptions()); },
+              [&] { sink = csv->search(queries.first()).size(); });
+    bench.run("search/exact", 0, QUERIES, [&] {
+        qint64 found = 0;
+        for (const QString& query : queries) found += csv->search(query).size();
+        sink = found;
+    });
+    bench.run("search/prefix", 0, QUERIES, [&] {
+        qint64 found = 0;
+        for (const QString& prefix : prefixes) found += csv->searchByPrefix(prefix).size();
+        sink = found;
+    });
+    csv.reset();
+    values.clear();
+    values.shrink_to_fit();
+
+    // ---------- 流式读取 ----------
+    bench.run("stream/operator>>", bytes, cells, [&] { loaded = std::make_unique<QCsv>(path); }, [&] {
+        QString value;
+        qint64 length = 0;
+        while (loaded->hasNext()) {
+            *loaded >> value;
+            length += value.size();
+        }
+        sink = length;
+    });
+    loaded.reset();
+    bench.run("stream/CsvReader", bytes, cells, [&] {
+        CsvReader reader(path, generator.separator);
+        qint64 fields = 0;
+        while (reader.nextRow()) fields += reader.row().size();
+        sink = fields;
+    });
+    QFile::remove(path);
+
+    QJsonObject config;
+    config.insert("rows", generator.rows);
+    config.insert("columns", generator.columns);
+    config.insert("quote_ratio", generator.quoteRatio);
+    config.insert("utf8_ratio", generator.utf8Ratio);
+    config.insert("numeric_ratio", generator.numericRatio);
+    config.insert("seed", static_cast<qint64>(generator.seed));
+    config.insert("bytes", bytes);
+
+    QJsonObject report;
+    report.insert("generator", config);
+    report.insert("cpu", QSysInfo::currentCpuArchitecture());
+    report.insert("instruction_set", CsvSimd::instructionSetName(CsvSimd::activeInstructionSet()));
+    report.insert("results", bench.results);
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QFile output(parser.value(outputOption));
+        if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+            qCritical() << "Could not write" << output.fileName();
+            return 1;
+        }
+    } else {
+        fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+    }
+    return 0;
+}
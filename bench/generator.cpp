@@ -0,0 +1,64 @@
+#include "generator.hpp"
+#include <iterator>
+#include <vector>
+
+namespace {
+
+const char* const MULTIBYTE[] = { "\xC3\xA9", "\xC3\x9F", "\xE4\xB8\xAD", "\xE6\x96\x87", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+
+void appendText(QByteArray& out, SplitMix64& random, const CsvGeneratorOptions& options) {
+    const bool quoted = random.unit() < options.quoteRatio;
+    const bool multibyte = random.unit() < options.utf8Ratio;
+    const int length = 3 + static_cast<int>(random.bounded(14));
+    const int special = static_cast<int>(random.bounded(length));
+
+    if (quoted) out.append('"');
+    for (int i = 0; i < length; ++i) {
+        if (quoted && i == special) {
+            // 只有加引号的字段才能包含这些字符
+            switch (random.bounded(3)) {
+                case 0: out.append(options.separator); break;
+                case 1: out.append("\"\""); break;
+                default: out.append('\n'); break;
+            }
+        } else if (multibyte && i % 3 == 0) {
+            out.append(MULTIBYTE[random.bounded(std::size(MULTIBYTE))]);
+        } else {
+            out.append(static_cast<char>('a' + random.bounded(26)));
+        }
+    }
+    if (quoted) out.append('"');
+}
+
+} // namespace
+
+QByteArray generateCsv(const CsvGeneratorOptions& options) {
+    SplitMix64 random(options.seed);
+    QByteArray out;
+    out.reserve(static_cast<qsizetype>(options.rows) * options.columns * 10);
+
+    // 数值列均匀分布在各列之间，依次交替为整数列和小数列
+    enum Kind { Text, Integer, Decimal };
+    std::vector<Kind> kinds;
+    int numericColumns = 0;
+    for (int col = 0; col < options.columns; ++col) {
+        const bool numeric = static_cast<int>((col + 1) * options.numericRatio) > static_cast<int>(col * options.numericRatio);
+        kinds.push_back(!numeric ? Text : (numericColumns++ % 2 == 0 ? Integer : Decimal));
+    }
+
+    for (int row = 0; row < options.rows; ++row) {
+        for (int col = 0; col < options.columns; ++col) {
+            if (col > 0) out.append(options.separator);
+
+            if (kinds[col] == Text) {
+                appendText(out, random, options);
+            } else if (kinds[col] == Integer) {
+                out.append(QByteArray::number(static_cast<qint64>(random.bounded(2000000)) - 1000000));
+            } else {
+                out.append(QByteArray::number(random.unit() * 10000.0, 'f', 3));
+            }
+        }
+        out.append('\n');
+    }
+    return out;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <QByteArray>
+#include <QtGlobal>
+
+// 确定性的合成 CSV 生成器：同样的参数和种子在任何平台上生成相同的字节
+struct CsvGeneratorOptions {
+    int rows = 100000;
+    int columns = 10;
+    double quoteRatio = 0.1;      // 加引号的文本字段比例（字段内含分隔符、转义引号或换行）
+    double utf8Ratio = 0.2;       // 含多字节 UTF-8 字符的文本字段比例
+    double numericRatio = 0.5;    // 数值列的比例，数值列交替为整数和小数
+    quint64 seed = 1;
+    char separator = ',';
+};
+
+QByteArray generateCsv(const CsvGeneratorOptions& options);
+
+// SplitMix64：不依赖标准库分布的实现，跨平台结果一致
+class SplitMix64 {
+public:
+    explicit SplitMix64(quint64 seed) : state(seed) {}
+
+    quint64 next() {
+        quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, bound)
+    quint64 bounded(quint64 bound) { return next() % bound; }
+    // [0, 1)
+    double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+private:
+    quint64 state;
+};
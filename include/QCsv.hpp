@@ -4,10 +4,25 @@
 #include <QHash>
 #include <QMultiMap>
 #include <QStringBuilder>
+#include <QStringView>
+#include <QAnyStringView>
+#include <climits>
+#include <iterator>
 #include <memory>
+#include <vector>
 #include <optional>
 #include <QFuture>
 
+class QFile;
+class CsvWriter;
+class CsvSource;
+class CsvPredicate;
+class CsvRowSelection;
+class QRegularExpression;
+class QIODevice;
+class QMutex;
+class QReadWriteLock;
+
 // 导出宏定义
 #if defined(QTCSV_SHARED)
     #if defined(_WIN32)
@@ -65,8 +80,45 @@ namespace CsvUtils {
         return {key.left(i), key.mid(i).toInt() - 1};
     }
     
+    // 由 0-based 行列构造键，例如 (0, 0) -> "A1"
+    inline QString cellKey(int row, int col) {
+        return numberToColumnRow(col) % QString::number(row + 1);
+    }
+
+    // 解析键为 0-based 行列，不分配内存；格式非法时返回 false
+    inline bool parseKey(QStringView key, int& row, int& col) {
+        qsizetype i = 0;
+        qint64 c = 0;
+        while (i < key.size() && key[i].isLetter()) {
+            c = c * 26 + (key[i].toUpper().toLatin1() - 'A' + 1);
+            if (c > INT_MAX) return false;
+            ++i;
+        }
+        if (i == 0 || i == key.size()) return false;
+
+        qint64 r = 0;
+        for (; i < key.size(); ++i) {
+            if (!key[i].isDigit()) return false;
+            r = r * 10 + key[i].digitValue();
+            if (r > INT_MAX) return false;
+        }
+        if (r < 1) return false;
+
+        row = static_cast<int>(r - 1);
+        col = static_cast<int>(c - 1);
+        return true;
+    }
+
+    // 将 0-based 行列打包为一个整数（用于搜索索引）
+    inline quint64 packCell(int row, int col) {
+        return (quint64(quint32(row)) << 32) | quint32(col);
+    }
+
+    inline int cellRow(quint64 cell) { return static_cast<int>(cell >> 32); }
+    inline int cellColumn(quint64 cell) { return static_cast<int>(cell & 0xFFFFFFFFu); }
+
     // 检查值是否需要引号包围
-    inline bool needsQuotes(const QString& value, char separator) {
+    inline bool needsQuotes(QStringView value, char separator) {
         return value.contains(separator) || 
                value.contains('"') || 
                value.contains('\n') || 
@@ -74,24 +126,259 @@ namespace CsvUtils {
     }
     
     // 转义CSV值中的引号
-    inline QString escapeQuotes(const QString& value) {
-        QString result = value;
+    inline QString escapeQuotes(QStringView value) {
+        QString result = value.toString();
         result.replace('"', "\"\"");
         return result;
     }
 }
 
-// CSV解析器状态机
-class CsvParser {
+// 列式单元格存储
+// 数据按行块组织（每块 BLOCK_ROWS 行），块内每列是一段连续的 Span 数组，
+// 单元格文本统一存放在块内共享的 UTF-16 字符堆中。行列均为 0-based，空值即不存在。
+// 单元格也可以只引用内存映射中的 UTF-8 字节，所在块第一次被读取时才整体解码。
+class CsvStorage {
 public:
-    enum State {
-        STATE_NORMAL,
-        STATE_IN_QUOTES,
-        STATE_QUOTE_IN_QUOTES,
-        STATE_END_OF_CELL,
-        STATE_END_OF_ROW
+    static constexpr int BLOCK_SHIFT = 12;
+    static constexpr int BLOCK_ROWS = 1 << BLOCK_SHIFT;
+
+    CsvStorage() = default;
+    // 拷贝只共享块（写时复制），之后任一方修改某块时才复制该块
+    CsvStorage(const CsvStorage& other);
+    CsvStorage& operator=(const CsvStorage& other);
+    CsvStorage(CsvStorage&&) noexcept = default;
+    CsvStorage& operator=(CsvStorage&&) noexcept = default;
+
+    // 返回的视图在下一次修改前有效；UTF-8 单元格所在的块会先整体解码为 UTF-16
+    QStringView view(int row, int col) const;
+    // 逐个解码，不改动存储
+    QString value(int row, int col) const;
+    // 按存储形式返回，不解码也不改动存储：UTF-8 单元格（映射或 UTF-8 存储）为 UTF-8 视图，其余为 UTF-16 视图
+    QAnyStringView storedView(int row, int col) const;
+    // 同 storedView，以 func(QStringView value, const char* utf8, qsizetype utf8Size) 的形式给出，
+    // UTF-8 单元格的 value 为空，其余单元格 utf8 为 nullptr
+    template<typename Func>
+    auto visit(int row, int col, Func&& func) const;
+    bool contains(int row, int col) const {
+        const Span* span = findSpan(row, col);
+        return span && span->length != 0;
+    }
+
+    void setValue(int row, int col, QStringView value);
+    // 直接写入 UTF-8 字节（解析器路径），ASCII 数据无需中间 QString
+    void setUtf8(int row, int col, const char* data, qsizetype size);
+
+    // UTF-8 存储：此后写入的单元格保留为 UTF-8 字节（ASCII 数据只占 UTF-16 的一半），读取 QString 时才解码。
+    // 映射单元格在释放映射时复制为 UTF-8 字节而不解码
+    void setUtf8Storage(bool enable) { utf8Native = enable; }
+    bool utf8Storage() const { return utf8Native; }
+
+    // 零拷贝：单元格只记录映射中的字节位置，data 必须位于 setMapping() 提供的映射内
+    void setMapping(std::shared_ptr<const char> data) { mapping = std::move(data); }
+    void setMapped(int row, int col, const char* data, qsizetype size);
+    // 解码（UTF-8 存储时复制）所有仍引用映射的单元格并释放映射（覆盖写源文件前必须调用）
+    void releaseMapping();
+    bool hasMapping() const { return mapping != nullptr; }
+    void remove(int row, int col) { setValue(row, col, QStringView()); }
+    void clear();
+
+    // 合并另一份存储（行区间互不重叠时整块移动，仅边界块逐单元格复制）
+    void merge(CsvStorage&& other);
+
+    // 逐块累加，不维护全局计数，写入不同块时互不影响
+    qsizetype size() const;
+    bool isEmpty() const { return size() == 0; }
+    // 已分配块覆盖的行数，写入该范围内的行不会改变块表
+    int rowCapacity() const { return static_cast<int>(blocks.size()) << BLOCK_SHIFT; }
+    // 存储自身分配内存的次数（新块、块表与列数组扩容、字符堆新建槽），供运行指标使用
+    qint64 allocationCount() const;
+
+    // 按行优先顺序遍历所有非空单元格：func(row, col, QStringView)。UTF-8 存储时逐个解码到临时缓冲区，
+    // 视图只在回调内有效
+    template<typename Func>
+    void forEach(Func&& func) const;
+    // 同 forEach，但不解码 UTF-8 单元格：func(row, col, QStringView value, const char* utf8, qsizetype utf8Size)，
+    // UTF-8 单元格（映射或 UTF-8 存储）的 utf8 指向原始字节、value 为空，其余单元格 utf8 为 nullptr
+    template<typename Func>
+    void forEachRaw(Func&& func) const;
+
+private:
+    // length 最高位置位表示 offset 指向映射（相对块的 mappedBase），长度为 UTF-8 字节数
+    static constexpr quint32 MAPPED = 0x80000000u;
+    // 次高位置位表示块内字符堆中的 UTF-8 字节（UTF-8 存储），长度为字节数
+    static constexpr quint32 UTF8 = 0x40000000u;
+    static constexpr quint32 LENGTH_MASK = 0x3FFFFFFFu;
+    // 不超过该长度的值直接存放在 Span 内，不占用字符堆
+    static constexpr quint32 INLINE_CHARS = 2;
+    static constexpr quint32 INLINE_BYTES = 4;
+
+    struct Span {
+        union {
+            quint32 offset = 0;
+            char16_t text[INLINE_CHARS];
+            char bytes[INLINE_BYTES];
+        };
+        quint32 length = 0;
+    };
+
+    // 块的字符堆：按槽分配，槽写满后新开一槽，已写入的字符不再移动，clear() 时整体释放。
+    // 偏移的高 16 位为槽号、低 16 位为槽内位置；超过一槽的分配独占连续多个槽号
+    class Arena {
+    public:
+        static constexpr int SLAB_SHIFT = 16;
+        static constexpr qsizetype SLAB_CHARS = qsizetype(1) << SLAB_SHIFT;
+        static constexpr qsizetype FIRST_SLAB_CHARS = 256;  // 槽从小到大倍增，小表不浪费内存
+
+        Arena() = default;
+        Arena(const Arena& other);
+        Arena& operator=(const Arena&) = delete;
+        Arena(Arena&&) noexcept = default;
+        Arena& operator=(Arena&&) noexcept = default;
+
+        char16_t* data(quint32 offset) const {
+            return segments[offset >> SLAB_SHIFT] + (offset & (SLAB_CHARS - 1));
+        }
+        // 分配 length 个连续字符并返回偏移，新建槽时 allocations 加一
+        quint32 allocate(qsizetype length, qint64& allocations);
+        // 保证接下来 length 个字符的分配不再新建槽
+        void reserve(qsizetype length, qint64& allocations);
+        qsizetype used() const { return usedChars; }
+
+    private:
+        struct Slab {
+            std::unique_ptr<char16_t[]> data;
+            quint32 first = 0;  // 首个槽号
+            quint32 count = 1;  // 占用的槽号数
+            qsizetype capacity = 0;
+            qsizetype used = 0;
+        };
+        std::vector<Slab> slabs;
+        std::vector<char16_t*> segments;  // 槽号到起始地址
+        qsizetype usedChars = 0;
+    };
+
+    struct Block {
+        std::vector<std::vector<Span>> columns;  // columns[col][localRow]
+        Arena heap;
+        qsizetype garbage = 0;                   // 被覆盖或删除后遗留的字符数
+        qsizetype cells = 0;                     // 块内非空单元格数
+        qsizetype mapped = 0;                    // 尚未解码的映射单元格数
+        qint64 mappedBase = -1;
+        qint64 allocations = 0;                  // 本块的内存分配次数
+
+        int rowExtent() const;
     };
 
+    std::vector<std::shared_ptr<Block>> blocks;  // 可能与快照共享，修改前先 detach
+    std::shared_ptr<const char> mapping;
+    qint64 blockAllocations = 0;                 // 块表扩容与新建块的次数
+    bool utf8Native = false;
+
+    const Span* findSpan(int row, int col) const;
+    Span& ensureSpan(int row, int col, Block*& block);
+    Block* detach(size_t b);
+    void prepareWrite(Block& block, Span& span);
+    // 把映射单元格和块内 UTF-8 单元格解码为 UTF-16；keepUtf8 时只把映射单元格复制为块内 UTF-8 字节
+    void materialize(Block& block, bool keepUtf8 = false) const;
+    static const char16_t* chars(const Block& block, const Span& span) {
+        return span.length <= INLINE_CHARS ? span.text : block.heap.data(span.offset);
+    }
+    // UTF-8 单元格的原始字节，UTF-16 单元格返回 nullptr
+    const char* utf8Data(const Block& block, const Span& span) const {
+        if (span.length & MAPPED) return mapping.get() + block.mappedBase + span.offset;
+        if (!(span.length & UTF8)) return nullptr;
+        return (span.length & LENGTH_MASK) <= INLINE_BYTES
+            ? span.bytes : reinterpret_cast<const char*>(block.heap.data(span.offset));
+    }
+    static qsizetype byteCount(const Span& span) { return span.length & LENGTH_MASK; }
+    // 值在字符堆中占用的单元数（内联和映射单元格为 0）
+    static qsizetype heapUnits(const Span& span) {
+        if (span.length & MAPPED) return 0;
+        if (span.length & UTF8) return byteCount(span) > INLINE_BYTES ? (byteCount(span) + 1) / 2 : 0;
+        return span.length > INLINE_CHARS ? span.length : 0;
+    }
+    static QStringView decode(std::vector<char16_t>& buffer, const char* data, qsizetype size);
+    static char16_t* allocate(Block& block, Span& span, qsizetype length);
+    static void writeUtf8(Block& block, Span& span, const char* data, qsizetype size);
+    static void writeBytes(Block& block, Span& span, const char* data, qsizetype size);
+    void store(Block& block, Span& span, const char* data, qsizetype size) const {
+        if (utf8Native) writeBytes(block, span, data, size);
+        else writeUtf8(block, span, data, size);
+    }
+    void compact(Block& block);
+};
+
+template<typename Func>
+auto CsvStorage::visit(int row, int col, Func&& func) const {
+    const Span* span = findSpan(row, col);
+    if (!span || span->length == 0) return func(QStringView(), nullptr, qsizetype(0));
+
+    const Block& block = *blocks[static_cast<size_t>(row) >> BLOCK_SHIFT];
+    if (const char* utf8 = utf8Data(block, *span)) return func(QStringView(), utf8, byteCount(*span));
+    return func(QStringView(chars(block, *span), span->length), nullptr, qsizetype(0));
+}
+
+template<typename Func>
+void CsvStorage::forEach(Func&& func) const {
+    std::vector<char16_t> buffer;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        Block* block = blocks[b].get();
+        if (!block) continue;
+        if (block->mapped && !utf8Native) materialize(*block);
+
+        const int baseRow = static_cast<int>(b) << BLOCK_SHIFT;
+        const int rows = block->rowExtent();
+        for (int local = 0; local < rows; ++local) {
+            for (size_t col = 0; col < block->columns.size(); ++col) {
+                const auto& spans = block->columns[col];
+                if (static_cast<size_t>(local) >= spans.size()) continue;
+                const Span& span = spans[local];
+                if (span.length == 0) continue;
+                if (const char* utf8 = utf8Data(*block, span)) {
+                    func(baseRow + local, static_cast<int>(col), decode(buffer, utf8, byteCount(span)));
+                } else {
+                    func(baseRow + local, static_cast<int>(col), QStringView(chars(*block, span), span.length));
+                }
+            }
+        }
+    }
+}
+
+template<typename Func>
+void CsvStorage::forEachRaw(Func&& func) const {
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const Block* block = blocks[b].get();
+        if (!block) continue;
+
+        const int baseRow = static_cast<int>(b) << BLOCK_SHIFT;
+        const int rows = block->rowExtent();
+        for (int local = 0; local < rows; ++local) {
+            for (size_t col = 0; col < block->columns.size(); ++col) {
+                const auto& spans = block->columns[col];
+                if (static_cast<size_t>(local) >= spans.size()) continue;
+                const Span& span = spans[local];
+                if (span.length == 0) continue;
+                if (const char* utf8 = utf8Data(*block, span)) {
+                    func(baseRow + local, static_cast<int>(col), QStringView(), utf8, byteCount(span));
+                } else {
+                    func(baseRow + local, static_cast<int>(col),
+                         QStringView(chars(*block, span), span.length), nullptr, 0);
+                }
+            }
+        }
+    }
+}
+
+// 引号状态。CsvParser、Utf8CsvParser 与 CsvReader 共用同一个分词器（src/QCsvTokenizer.hpp）
+enum class CsvQuoteState : quint8 {
+    Normal,
+    InQuotes,
+    QuoteInQuotes   // 引号内读到引号：后跟引号为转义，否则引号部分结束
+};
+
+// CSV解析器：逐字段转换为 QString，同时写入存储和搜索模型
+class CsvParser {
+public:
     struct Statistics {
         int maxRow = 0;
         int maxCol = 0;
@@ -99,8 +386,8 @@ public:
         int emptyCells = 0;
     };
 
-    CsvParser(QHash<QString, QString>& csvModel, 
-              QMultiMap<QString, QString>& searchModel,
+    CsvParser(CsvStorage& storage, 
+              QMultiMap<QString, quint64>& searchModel,
               char separator);
 
     void parse(const char* data, size_t size, bool isFinal = false);
@@ -111,25 +398,28 @@ public:
     void resetStatistics();
 
 private:
-    QHash<QString, QString>& csvModel;
-    QMultiMap<QString, QString>& searchModel;
+    static constexpr size_t WINDOW_SIZE = 1024 * 1024;
+
+    CsvStorage& storage;
+    QMultiMap<QString, quint64>& searchModel;
     char separator;
     
     int currentRow = 0;
     int currentCol = 0;
-    QString currentCell;
-    State state = STATE_NORMAL;
+    QByteArray cellBytes;              // 跨窗口或含转义引号的字段在此累积
+    std::vector<quint32> structural;
+    CsvQuoteState state = CsvQuoteState::Normal;
     bool pendingCR = false;
     
     Statistics stats;
     
-    void processChar(char ch);
-    void endCell();
+    void endCell(const char* begin, const char* end);
     void endRow();
-    void insertCell();
 };
 
 // UTF-8感知的CSV解析器
+// 先用 SIMD 扫描出窗口内所有结构字符（分隔符、引号、CR、LF）的位置，
+// 状态机只在这些位置上运行，字段字节整段解码，不再逐字符处理。
 class Utf8CsvParser {
 public:
     struct Statistics {
@@ -137,46 +427,329 @@ public:
         int maxCol = 0;
         int totalCells = 0;
         int emptyCells = 0;
+        int quotedCells = 0;
+        qint64 bytes = 0;          // 交给解析器的字节数
+        qint64 tokenizeNs = 0;     // SIMD 结构字符扫描（setTiming 开启时记录）
+        qint64 insertNs = 0;       // 状态机切分字段、解码并写入存储（同上）
     };
 
-    Utf8CsvParser(QHash<QString, QString>& csvModel, 
-                  QMultiMap<QString, QString>& searchModel,
-                  char separator);
+    Utf8CsvParser(CsvStorage& storage, char separator);
 
     void parse(const char* data, size_t size, bool isFinal = false);
     void finalize();
+
+    // 设置首行的行号（0-based），并行加载时每个分块从各自的全局行号开始
+    void setStartRow(int row) { currentRow = row; }
+
+    // 输入位于存储持有的映射内时，未加引号的字段只记录字节位置，不解码
+    void setZeroCopy(bool enable) { zeroCopy = enable; }
+
+    // 只建立行起始偏移索引（相对 base），不写入存储
+    void setRowIndex(std::vector<quint64>* offsets, const char* base);
+
+    // 列投影：columns[源列] 为目标列（均 0-based），-1 或超出范围的列只分词、不解码也不写入存储。
+    // columns 须在解析期间保持有效
+    void setProjection(const std::vector<int>* columns);
+
+    // 按窗口分别计时结构字符扫描与字段处理，每 1MB 只多读几次时钟
+    void setTiming(bool enable) { timing = enable; }
     
     const Statistics& getStatistics() const { return stats; }
     void resetStatistics();
 
 private:
-    enum State {
-        STATE_NORMAL,
-        STATE_IN_QUOTES,
-        STATE_QUOTE_IN_QUOTES,
-        STATE_END_OF_CELL,
-        STATE_END_OF_ROW
-    };
+    static constexpr size_t WINDOW_SIZE = 1024 * 1024;
 
-    QHash<QString, QString>& csvModel;
-    QMultiMap<QString, QString>& searchModel;
+    CsvStorage& storage;
     char separator;
     
     int currentRow = 0;
     int currentCol = 0;
-    QString currentCell;
-    QByteArray utf8Buffer;  // 用于累积UTF-8字符的缓冲区
-    State state = STATE_NORMAL;
-    bool pendingCR = false;
+    QByteArray cellBytes;              // 跨窗口或含转义引号的字段在此累积
+    std::vector<quint32> structural;   // 当前窗口的结构字符偏移
+    CsvQuoteState state = CsvQuoteState::Normal;
+    bool pendingCR = false;            // 上一窗口以行尾的 CR 结束，紧随的 LF 需跳过
+    bool zeroCopy = false;
+    std::vector<quint64>* rowIndex = nullptr;
+    const char* indexBase = nullptr;
+    const std::vector<int>* projection = nullptr;
+    bool skipCell = false;             // 当前字段不在投影内
+    bool timing = false;
     
     Statistics stats;
     
-    void processUtf8Char(const char*& ptr, const char* end);
-    void flushUtf8Char();
-    void processChar(QChar ch);
-    void endCell();
+    void parseWindow(const char* begin, const char* end);
+    void endCell(const char* begin, const char* end);
     void endRow();
-    void insertCell();
+    void setColumn(int col);
+    void insertCell(int col, const char* data, qsizetype size, bool direct);
+};
+
+// 流式逐行读取器（拉取式解析）
+// 与 load() 使用同一套 SIMD 结构字符扫描和引号状态机，每次 nextRow() 只解析一行。
+// 文件按块读入，内存占用与文件大小无关；行对象在多次读取之间复用，稳定状态下不再分配内存。
+class QTCSV_EXPORT CsvReader {
+public:
+    // 读取后端
+    enum class IoBackend {
+        Buffered,   // 按块 read() 到可配置大小的缓冲区
+        MemoryMap,  // 映射整个文件，按块在映射上解析，不复制数据
+        ReadAhead   // 后台线程预读到双缓冲区，解析与磁盘读取重叠进行
+    };
+
+    struct Options {
+        IoBackend backend = IoBackend::Buffered;
+        qsizetype bufferSize = 1024 * 1024;       // 每次读取（扫描）的块大小
+        int indexStride = 0;                      // 读取时每隔多少行记录一次行起始偏移，供 seekToRow() 使用；0 表示不记录
+        bool persistIndex = false;                // 完整扫描后把行索引存为旁路文件（<文件名>.idx），下次打开时校验后复用
+    };
+
+    // 一行的字段视图，只在下一次 nextRow() 之前有效
+    class QTCSV_EXPORT Row {
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = QStringView;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = QStringView;
+
+            const_iterator() = default;
+            QStringView operator*() const { return row->field(index); }
+            const_iterator& operator++() { ++index; return *this; }
+            const_iterator operator++(int) { const_iterator it = *this; ++index; return it; }
+            bool operator==(const const_iterator& other) const { return index == other.index; }
+            bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+        private:
+            friend class Row;
+            const_iterator(const Row* row, int index) : row(row), index(index) {}
+            const Row* row = nullptr;
+            int index = 0;
+        };
+
+        int size() const { return static_cast<int>(fields.size()); }
+        bool isEmpty() const { return fields.empty(); }
+        qint64 number() const { return rowNumber; }          // 0-based 行号
+
+        // 0-based 列，越界时返回空视图
+        QStringView field(int col) const;
+        QStringView operator[](int col) const { return field(col); }
+        QStringList toStringList() const;
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, size()); }
+
+    private:
+        friend class CsvReader;
+        struct Field {
+            size_t offset;
+            qsizetype length;
+        };
+        std::vector<char16_t> text;     // 整行解码后的字符，只增不减
+        size_t textSize = 0;
+        std::vector<Field> fields;
+        qint64 rowNumber = -1;
+    };
+
+    // 输入迭代器，for (const CsvReader::Row& row : reader) 从当前位置读到文件末尾
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Row*;
+        using reference = const Row&;
+
+        iterator() = default;
+        reference operator*() const { return reader->row(); }
+        pointer operator->() const { return &reader->row(); }
+        iterator& operator++() {
+            if (!reader->nextRow()) reader = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return reader == other.reader; }
+        bool operator!=(const iterator& other) const { return reader != other.reader; }
+
+    private:
+        friend class CsvReader;
+        explicit iterator(CsvReader* reader) : reader(reader) {}
+        CsvReader* reader = nullptr;
+    };
+
+    explicit CsvReader(const QString& filePath, char separator = ',');
+    CsvReader(const QString& filePath, char separator, const Options& options);
+    ~CsvReader();
+
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return source != nullptr; }
+    // 回到文件开头重新读取
+    bool rewind();
+
+    // 定位到第 row 行（0-based），下一次 nextRow() 读出该行。
+    // 有行索引时从最近的索引点开始，只需解析不到 indexStride 行；目标超出已索引的范围时向后扫描并补全索引
+    bool seekToRow(qint64 row);
+    // 扫描整个文件建立行索引（需要 indexStride > 0），完成后回到文件开头
+    bool buildIndex();
+    // 行索引已覆盖整个文件时返回总行数，否则返回 -1
+    qint64 rowCount() const { return indexedRows; }
+
+    // 读取下一行到 row()；未打开时先打开，到达文件末尾或出错时返回 false
+    bool nextRow();
+    const Row& row() const { return current; }
+    bool atEnd() const { return finished; }
+    qint64 rowsRead() const { return rows; }         // 下一次 nextRow() 读出的行号
+
+    // 流式过滤：读到下一个满足 predicate 的行为止，内存占用与文件大小无关
+    bool nextMatchingRow(const CsvPredicate& predicate);
+    // 从当前位置读到文件末尾，返回满足 predicate 的行（按文件中的 0-based 行号）
+    CsvRowSelection select(const CsvPredicate& predicate);
+
+    iterator begin() { return nextRow() ? iterator(this) : iterator(); }
+    iterator end() { return iterator(); }
+
+    QString getFilePath() const { return filePath; }
+    char getSeparator() const { return separator; }
+    QString errorString() const { return lastError; }
+
+    // 用每个后端各完整读取一遍文件并计时，返回最快的后端。
+    // 先预读一遍让各后端都在热页缓存上比较；结果适用于同一设备上的同类文件。
+    static IoBackend fastestBackend(const QString& filePath, char separator = ',',
+                                    qsizetype bufferSize = 1024 * 1024);
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    QString filePath;
+    char separator;
+    Options options;
+    std::unique_ptr<CsvSource> source;
+
+    const char* window = nullptr;       // 后端提供的当前数据块
+    size_t dataEnd = 0;                 // 数据块的长度
+    size_t fieldStart = 0;              // 当前字段尚未累积的字节起点，之前的字节都已处理
+    size_t crNext = NONE;               // 紧跟行尾 CR 的位置，此处的 LF 不再结束一行
+    std::vector<quint32> structural;    // 最近一次读入的字节中结构字符相对 scanBase 的偏移
+    size_t scanBase = 0;
+    size_t nextStructural = 0;
+    QByteArray fieldBytes;              // 含引号的字段在此拼接
+    CsvQuoteState state = CsvQuoteState::Normal;
+    bool eof = false;
+    bool finished = false;
+    qint64 rows = 0;
+    Row current;
+    QString lastError;
+
+    quint64 windowOffset = 0;           // 数据块开头在文件中的偏移
+    std::vector<quint64> rowStarts;     // 第 k 项为第 k * indexStride 行的起始偏移
+    qint64 indexedRows = -1;            // 索引覆盖整个文件后为总行数
+    bool indexCR = false;               // 最后一个索引点位于行尾 CR 之后，其后若是 LF 需要后移
+    bool skipping = false;              // 定位时跳过的行不解码
+
+    void reset();
+    bool fill();
+    void endField(const char* begin, const char* end);
+    void recordRowStart(quint64 offset, bool afterCR);
+    QString indexPath() const;
+    bool loadIndex();
+    bool saveIndex() const;
+};
+
+// 行选择（过滤结果），第 i 位对应 0-based 第 i 行，每行只占一位
+class QTCSV_EXPORT CsvRowSelection {
+public:
+    CsvRowSelection() = default;
+    explicit CsvRowSelection(qint64 rows) : total(rows), words(static_cast<size_t>((rows + 63) / 64)) {}
+
+    qint64 size() const { return total; }                   // 覆盖的总行数
+    qint64 count() const;                                   // 选中的行数
+    bool isEmpty() const { return count() == 0; }
+    bool contains(qint64 row) const {
+        return row >= 0 && row < total && ((words[row >> 6] >> (row & 63)) & 1);
+    }
+    // 选中第 row 行，超出 size() 时扩展
+    void select(qint64 row);
+    void deselect(qint64 row);
+    // 调整覆盖的行数，缩小时丢弃超出的行
+    void resize(qint64 rows);
+
+    // 选中行的 0-based 行号，升序
+    std::vector<qint64> toRowIds() const;
+    const std::vector<quint64>& bitmap() const { return words; }
+    std::vector<quint64>& bitmap() { return words; }
+
+    CsvRowSelection& operator&=(const CsvRowSelection& other);
+    CsvRowSelection& operator|=(const CsvRowSelection& other);
+
+private:
+    qint64 total = 0;
+    std::vector<quint64> words;
+};
+
+// 行过滤条件（QCsv::filter、CsvReader::nextMatchingRow）
+// 叶子条件作用于一列（1-based），可用 && 与 || 组合：
+//     CsvPredicate::equals(2, "北京") && CsvPredicate::range(3, 10, 20)
+// 空单元格不满足任何叶子条件；默认构造的条件匹配所有行。
+class QTCSV_EXPORT CsvPredicate {
+public:
+    CsvPredicate() = default;
+
+    static CsvPredicate equals(int col, const QString& value);
+    static CsvPredicate in(int col, const QStringList& values);
+    // 数值比较：单元格按数字解析，不能解析的单元格不满足条件
+    static CsvPredicate less(int col, double value);
+    static CsvPredicate lessEqual(int col, double value);
+    static CsvPredicate greater(int col, double value);
+    static CsvPredicate greaterEqual(int col, double value);
+    static CsvPredicate range(int col, double low, double high);     // low <= x <= high
+    // 文本匹配
+    static CsvPredicate prefix(int col, const QString& prefix);
+    static CsvPredicate contains(int col, const QString& text, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+    static CsvPredicate regex(int col, const QRegularExpression& pattern);
+
+    CsvPredicate operator&&(const CsvPredicate& other) const;
+    CsvPredicate operator||(const CsvPredicate& other) const;
+
+    // 对一行求值（流式过滤）
+    bool matches(const CsvReader::Row& row) const;
+
+    struct Node;
+
+private:
+    friend class QCsv;
+    explicit CsvPredicate(std::shared_ptr<const Node> node) : node(std::move(node)) {}
+    std::shared_ptr<const Node> node;   // 不可变，组合时共享子树
+};
+
+// 类型化列的只读视图（QCsv::columnAsDouble / columnAsInt64）
+// 下标为 0-based 行号，空单元格的值为 0，以非空位图区分。视图在下一次加载、清空或表格增加行之前有效。
+template<typename T>
+class CsvColumnView {
+public:
+    CsvColumnView() = default;
+    CsvColumnView(const T* values, qsizetype count, const quint64* validity)
+        : values(values), count(count), validity(validity) {}
+
+    qsizetype size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    const T* data() const { return values; }
+    const T& operator[](qsizetype row) const { return values[row]; }
+    const T* begin() const { return values; }
+    const T* end() const { return values + count; }
+
+    // 第 i 位为 1 表示第 i 行有值，共 (size() + 63) / 64 个字
+    const quint64* validityBitmap() const { return validity; }
+    bool isNull(qsizetype row) const { return !((validity[row >> 6] >> (row & 63)) & 1); }
+
+private:
+    const T* values = nullptr;
+    qsizetype count = 0;
+    const quint64* validity = nullptr;
 };
 
 class QTCSV_EXPORT QCsv : public QObject {
@@ -202,6 +775,108 @@ public:
     void close();
     bool isOpen() const;
     
+    // 搜索索引类型
+    enum class SearchIndexKind {
+        Ordered,    // 有序多重映射：search / searchByPrefix 均为 O(log n)，修改时增量维护
+        Hash,       // 哈希索引：search 为 O(1)；前缀查询时另建排序数组
+        Sorted      // 按值排序的单元格数组：内存最省，修改后在下次搜索时重建
+    };
+
+    // 加载选项
+    struct LoadOptions {
+        bool parallel = false;                        // 多线程并行解析
+        int threadCount = 0;                          // 0 表示使用 QThread::idealThreadCount()
+        qint64 parallelThreshold = 8 * 1024 * 1024;   // 小于该字节数的文件仍串行加载
+        bool memoryMap = false;                       // 直接在文件映射上解析，不再分块读入
+        // 配合 memoryMap：单元格保留为映射字节，首次读取时按块解码。此时加载不预先建立搜索索引
+        // （buildSearchIndex 不起作用），索引在首次搜索时建立并解码全部单元格
+        bool deferDecode = false;
+        // 单元格保留为 UTF-8 字节（ASCII 数据约为 UTF-16 的一半内存），getValue 时逐个转换为 QString，
+        // 保存与聚合直接使用原始字节。排序索引（SearchIndexKind::Sorted）按码点比较 UTF-8 字节
+        bool utf8Storage = false;
+        bool lazy = false;                            // 只建立行索引，按需解析被访问的行
+        int rowCacheSize = 4096;                      // 懒加载模式下缓存的已解析行数
+        bool buildSearchIndex = true;                 // false 时加载不建立搜索索引，首次搜索时再建立（deferDecode 时总是如此）
+        SearchIndexKind searchIndexKind = SearchIndexKind::Ordered;
+        bool trackChanges = false;                    // 记录源文件行偏移并跟踪被修改的行，save() 时只重写这些行
+        bool inferTypes = false;                      // 加载后推断每列的类型，数值、布尔、日期列另存为原生数组
+        // 列投影：只加载选中的列，按给出的顺序重新编号为 1..n（先 columns 后 columnNames），
+        // 其余字段在分词后直接跳过、不解码。与 trackChanges 不兼容（忽略后者），加载后不能保存回源文件
+        QList<int> columns;                           // 1-based 源列号
+        QStringList columnNames;                      // 按表头行（headerRow）的列名选择
+        // 行范围与抽样：只解析选中的行，按文件中的顺序重新编号。启用表头（enableHeaders）时前 headerRow 行
+        // 始终保留，以下行号从其后的数据行算起（0-based）。与 lazy、parallel、trackChanges 不兼容（忽略后者）。
+        // 加载后不能保存回源文件（save 返回 false），只能另存为其它路径
+        qint64 startRow = 0;                          // 跳过的行数
+        qint64 rowLimit = -1;                         // 最多加载的行数，-1 表示不限
+        qint64 tailRows = 0;                          // >0 时只加载最后 tailRows 行（从文件尾向前扫描），忽略 startRow、stride、sampleSize
+        int stride = 1;                               // 每 stride 行取一行
+        qint64 sampleSize = 0;                        // >0 时在候选行中蓄水池抽样，结果保持文件中的顺序
+        quint32 sampleSeed = 0;                       // 抽样的随机种子，0 表示每次不同
+    };
+
+    // 列类型（LoadOptions::inferTypes）。一列中所有非空单元格都能解析为某类型时取该类型，
+    // 按 Int64、Double、Bool、Date 的顺序优先；启用表头（enableHeaders）时表头行不参与推断。
+    enum class ColumnType {
+        String,
+        Int64,
+        Double,
+        Bool,      // true / false（不区分大小写）
+        Date       // ISO 日期 yyyy-MM-dd
+    };
+
+    // 列聚合结果（aggregate / aggregateBy），count 为 0 时其余字段均为 0
+    struct Aggregate {
+        qint64 count = 0;       // 参与统计的数值个数
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+        double mean = 0;
+        double variance = 0;    // 总体方差
+    };
+
+    // 运行指标（setMetricsEnabled），时间单位为纳秒。并行加载时扫描与写入时间为各线程之和；
+    // 内存映射时缺页读盘发生在解析过程中，计入解析时间而非 ioWaitNs
+    struct Metrics {
+        // 最近一次 load()
+        qint64 loadNs = 0;
+        qint64 bytesRead = 0;          // 交给解析器的字节数
+        qint64 ioWaitNs = 0;           // 读取文件、建立映射
+        qint64 tokenizeNs = 0;         // SIMD 结构字符扫描
+        qint64 insertNs = 0;           // 切分字段、解码并写入存储
+        qint64 typeInferenceNs = 0;
+        qint64 rows = 0;
+        qint64 cells = 0;              // 非空单元格
+        qint64 emptyCells = 0;
+        qint64 quotedCells = 0;
+        qint64 allocations = 0;        // 存储分配内存的次数
+        // 最近一次建立搜索索引（加载时或首次查找时）
+        qint64 indexBuildNs = 0;
+        // 最近一次保存（save、saveAs、atomicSave*、sync）
+        qint64 saveNs = 0;
+        qint64 savePrepareNs = 0;      // 解码映射、整体解析懒加载数据、复制快照
+        qint64 saveWriteNs = 0;        // 编码并写入
+        qint64 saveCommitNs = 0;       // 关闭文件或原子替换
+        qint64 bytesWritten = 0;
+
+        double quotedRatio() const {
+            const qint64 fields = cells + emptyCells;
+            return fields > 0 ? static_cast<double>(quotedCells) / fields : 0.0;
+        }
+    };
+
+    void setLoadOptions(const LoadOptions& options) { loadOptions = options; }
+    LoadOptions getLoadOptions() const { return loadOptions; }
+
+    // 开启后记录各阶段耗时与计数，每次 load() 和保存结束时发出 metricsReady；关闭时只多一次指针判断
+    void setMetricsEnabled(bool enable);
+    bool metricsEnabled() const { return metricsState != nullptr; }
+    Metrics metrics() const;
+    // 开启以来记录的阶段，Chrome trace 事件格式的 JSON，可在 chrome://tracing 或 Perfetto 中打开。
+    // 保留最近的 MAX_TRACE_EVENTS 个事件，更早的被覆盖
+    QByteArray metricsTrace() const;
+    static constexpr int MAX_TRACE_EVENTS = 10000;
+
     // 数据加载和保存
     void load();
     bool save();
@@ -210,7 +885,42 @@ public:
     bool atomicSaveAs(const QString& filePath);
     void clear();
     
-    // 异步操作
+    // 并发模式：开启后公开方法内部加锁，可多线程同时读写单元格并在后台保存。
+    // 单元格按行区间（一个存储块）分片加锁，不同分片的写入互不阻塞；加载、清空等结构性操作独占整表。
+    // 保存时只在复制快照期间阻塞写入，不阻塞读取。开启后加载结果立即整体解码（不保留懒加载和延迟解码），
+    // 流式读取（operator>>）不在保护范围内。须在多个线程开始访问之前设置。
+    void setConcurrent(bool enable);
+    bool isConcurrent() const { return locks != nullptr; }
+
+    // 某一时刻数据的只读快照。与 QCsv 按存储块共享数据（写时复制），
+    // 之后 QCsv 修改到的块才会被复制；快照可在任意线程读取。
+    class QTCSV_EXPORT Snapshot {
+    public:
+        Snapshot() = default;
+
+        QString getValue(const QString& key) const;
+        QString getValue(int row, int col) const;   // 1-based
+        int getRowCount() const { return rows; }
+        int getColumnCount() const { return cols; }
+        int size() const { return static_cast<int>(storage.size()); }
+        bool isEmpty() const { return storage.isEmpty(); }
+
+        // 以 UTF-8 CSV 格式写出
+        bool writeTo(QIODevice& device) const;
+
+    private:
+        friend class QCsv;
+        CsvStorage storage;
+        int rows = 1;
+        int cols = 1;
+        char separator = ',';
+    };
+
+    // 懒加载或延迟解码的数据会先整体解码
+    Snapshot snapshot();
+
+    // 异步操作：在调用线程拍快照，后台线程写出快照，调用方可以继续修改。
+    // fileSaved、error、metricsReady 在后台线程发出；析构时等待未完成的写出
     QFuture<bool> sync();
     void finalize(); // 保存并关闭
     
@@ -218,10 +928,22 @@ public:
     QString getValue(const QString& key) const;
     std::optional<QString> tryGetValue(const QString& key) const;
     void setValue(const QString& key, const QString& value);
+
+    // 整数行列访问（1-based），跳过键的构造与解析
+    QString getValue(int row, int col) const;
+    void setValue(int row, int col, const QString& value);
+
+    // 不转换为 QString 的读取（1-based）。getValueView 按存储形式返回：UTF-8 存储（LoadOptions::utf8Storage）
+    // 或延迟解码的单元格为 UTF-8 视图，其余为 UTF-16 视图，在下一次修改或保存前有效；空单元格为空视图。
+    // 无法给出视图时返回 std::nullopt（改用 getValue）：懒加载模式下尚未修改的行不在存储中；
+    // 并发模式（setConcurrent）下其它线程的修改随时可能使视图失效
+    std::optional<QAnyStringView> getValueView(int row, int col) const;
+    // UTF-8 字节，UTF-8 单元格直接复制不解码
+    QByteArray getValueUtf8(int row, int col) const;
     
     // 批量操作
     void setValues(const QHash<QString, QString>& values);
-    QHash<QString, QString> getAllValues() const { return csvModel; }
+    QHash<QString, QString> getAllValues() const;
     
     // 搜索功能
     QList<QString> search(const QString& value) const;
@@ -234,26 +956,35 @@ public:
     QString getFilePath() const { return filePath; }
     
     // 获取行列信息
-    int getRowCount() const { return maxRow; }
-    int getColumnCount() const { return maxCol; }
+    int getRowCount() const;
+    int getColumnCount() const;
     
-    // 流式读取
+    // 流式读取：逐个读出单元格（按行优先顺序，不区分行边界）；需要按行读取时使用 CsvReader
     friend QCsv& operator>>(QCsv& csv, QString& value);
     
     // 检查单元格是否存在
-    bool contains(const QString& key) const { return csvModel.contains(key); }
+    bool contains(const QString& key) const;
     
     // 获取所有键
-    QList<QString> keys() const { return csvModel.keys(); }
+    QList<QString> keys() const;
     
     // 获取大小
-    int size() const { return csvModel.size(); }
-    bool isEmpty() const { return csvModel.isEmpty(); }
+    int size() const;
+    bool isEmpty() const { return size() == 0; }
 
     void resetStream();
 
     bool hasNext() const;
 
+    // 流式读取使用的读取器选项（读取后端、行索引），在第一次 operator>> 之前设置。
+    // 默认每 64 行记录一次行偏移
+    void setStreamOptions(const CsvReader::Options& options) { streamOptions = options; }
+    CsvReader::Options getStreamOptions() const { return streamOptions; }
+
+    // 定位流式读取位置（1-based），下一次 operator>> 读出该单元格。
+    // 借助行偏移索引从最近的索引点开始解析，不必从文件开头重新读取
+    bool seekToCell(int row, int col);
+
     // 头部处理
     void enableHeaders(bool enable);
     bool headersEnabled() const { return headersOn; }
@@ -283,6 +1014,42 @@ public:
     qint64 getFileSize() const;
     QMap<QString, QVariant> getAllMetadata() const;
 
+    // 类型化访问（1-based）。列已推断为对应类型时直接读取原生数组，否则解析单元格字符串。
+    // 写入与列类型不符的值后该列退化为 String。
+    ColumnType getColumnType(int col) const;
+    std::optional<qint64> getInt64(int row, int col) const;
+    std::optional<double> getDouble(int row, int col) const;
+    std::optional<bool> getBool(int row, int col) const;
+    std::optional<QDate> getDate(int row, int col) const;
+
+    // 整列原生数组，不经过字符串（1-based 列）。Int64、Double、Bool 列可取 double 视图；
+    // Int64、Bool（0/1）、Date（儒略日）列可取 int64 视图；其他情况返回空视图。
+    // 视图直接指向内部数组，load、clear 与 setValue（追加行会重新分配数组）后失效；
+    // 并发模式（setConcurrent）下其它线程随时可能修改数组，总是返回空视图
+    CsvColumnView<double> columnAsDouble(int col) const;
+    CsvColumnView<qint64> columnAsInt64(int col) const;
+
+    // 列聚合（1-based 列），只统计能解析为数字的非空单元格，启用表头时跳过表头行。
+    // Int64、Double 列直接在原生数组上用 SIMD 计算，其他列（包括 Bool 列）逐格解析。
+    // threads 不为 1 时大列分块并行计算（0 表示使用 QThread::idealThreadCount()）
+    Aggregate aggregate(int col, int threads = 1) const;
+    // 按 groupCol 单元格的文本分组聚合，groupCol 为空的行归入空字符串组
+    QHash<QString, Aggregate> aggregateBy(int col, int groupCol) const;
+    double sum(int col) const;
+    std::optional<double> min(int col) const;
+    std::optional<double> max(int col) const;
+    std::optional<double> mean(int col) const;
+    std::optional<double> variance(int col) const;
+    // 非空单元格数，以及其中不同值的个数（类型化列按值比较，其他列按文本比较）
+    qint64 count(int col) const;
+    qint64 countDistinct(int col) const;
+
+    // 过滤（1-based 列），逐列求值后按 AND / OR 合并位图，启用表头时表头行不会被选中。
+    // 类型化数值列上的比较直接用 SIMD 扫描原生数组；搜索索引已建立时 ==、IN 经索引查找。
+    // filter 的第 i 位对应第 i + 1 行；findRows 返回选中的行号（1-based，升序）
+    CsvRowSelection filter(const CsvPredicate& predicate) const;
+    QList<int> findRows(const CsvPredicate& predicate) const;
+
     // 类型判断
     bool isNumeric(const QString& value) const;
     bool isDate(const QString& value, const QString& format = "yyyy-MM-dd") const;
@@ -303,7 +1070,7 @@ public:
 
     //大文件处理
     //void loadLargeFile(const QString& filePath);
-    //void appendToLargeFile(const QString& filePath, const QHash<QString, QString>& newData);
+    // 追加写入见 QCsvAppender
 
     // ------------------------------ 未来功能 -----------------------------
 
@@ -314,48 +1081,151 @@ signals:
     void fileClosed();
     void fileSaved(const QString& filePath);
     void error(const QString& errorString);
+    void metricsReady(const QCsv::Metrics& metrics);
 
 private:
     QString filePath;
-    QHash<QString, QString> csvModel;
-    QMultiMap<QString, QString> searchModel;
+    CsvStorage storage;
     char separator = ',';
+    LoadOptions loadOptions;
+    std::vector<int> projection;    // 列投影（LoadOptions::columns / columnNames）：源列 -> 目标列，-1 为跳过；未投影时为空
+    bool rowSubset = false;         // 只加载了部分行（行范围与抽样），行号已重新编号
+
+    // 懒加载状态（源数据、行索引、行缓存），非懒加载模式下为空
+    struct LazyRows;
+    std::unique_ptr<LazyRows> lazy;
+
+    // 反向搜索索引（单元格值 -> 单元格），按需建立
+    struct SearchIndex;
+    std::unique_ptr<SearchIndex> searchIndex;
+
+    // 源文件的行偏移与被修改的行（LoadOptions::trackChanges），用于增量保存
+    struct SourceRows;
+    std::unique_ptr<SourceRows> sourceRows;
+
+    // 类型化列（LoadOptions::inferTypes），未推断时为空
+    struct TypedColumns;
+    std::unique_ptr<TypedColumns> typed;
+
+    // 运行指标，未开启时为空；Phase 为计时一个阶段的 RAII 辅助类。
+    // 后台保存（sync）持有一份引用，期间关闭指标不会释放正在记录的状态
+    struct MetricsState;
+    class Phase;
+    std::shared_ptr<MetricsState> metricsState;
+    void publishMetrics();
+
+    // 并发模式下的锁（整表读写锁、行分片锁、搜索索引锁），非并发模式下为空
+    struct Locks;
+    std::unique_ptr<Locks> locks;
+    // 尚未完成的 sync()，后台线程会在本对象上发出信号，析构时等待它们结束
+    QList<QFuture<bool>> pendingSyncs;
     bool opened = false;
     int maxRow = 1;
     int maxCol = 1;
     bool headersOn = false;
 
-    // 流式读取相关
-    mutable int currentRow = 0;
-    mutable int currentCol = 0;
-    mutable QString currentCell;
-    mutable CsvParser::State state = CsvParser::STATE_NORMAL;
-    mutable bool pendingCR = false;
-    mutable bool atEnd = false;
-
-    std::unique_ptr<std::ifstream> fileStream;
-    std::vector<char> buffer;
-    size_t bufferPos = 0;
-    size_t bufferSize = 0;
-    const size_t BUFFER_SIZE = 16384; 
+    // 流式读取相关（operator>>），逐行从 CsvReader 拉取
+    CsvReader::Options streamOptions;
+    std::unique_ptr<CsvReader> streamReader;
+    int streamCol = 0;                  // 当前行中下一个要读出的字段
+    bool atEnd = false;
 
     // 头名称
     int headerRow = 1;
     int headerCol = 1;
     
     // 私有辅助方法
+    Utf8CsvParser::Statistics loadSerial(QFile& file);
+    Utf8CsvParser::Statistics loadMapped(QFile& file);
+    Utf8CsvParser::Statistics loadLazy(QFile& file);
+    bool isLazyRow(int row) const;
+    QStringList lazyRow(int row) const;
+    QStringList parseLazyRow(int row) const;
+    void loadLazyRow(int row);
+    void materializeLazy();
+    QString cellValue(int row, int col) const;
+    template<typename Func>
+    void forEachCell(Func&& func) const;
+    template<typename Func>
+    void forEachInColumn(int col, Func&& func) const;
+    void selectRows(const CsvPredicate::Node& node, CsvRowSelection& out) const;
+    Utf8CsvParser::Statistics loadParallel(QFile& file);
+    Utf8CsvParser::Statistics loadRows(QFile& file);
     void openStream();
     void closeStream();
-    bool readNextCell(QString& result);
-    void endCell();
-    void endRow();
-    bool getNextChar(char& ch);
-    void appendToCurrentCell(char ch);
-    void updateMaxRowCol(const QString& key);
-    bool writeToStream(QTextStream& out) const;
-    void removeFromSearch(const QString& value, const QString& key);
-    
-#if EXPERIMENTAL_FUNC
-    bool seekToCell(int targetRow, int targetCol);
-#endif
-};
\ No newline at end of file
+    void updateMaxRowCol(int row, int col);
+    void inferColumnTypes();
+    std::vector<int> resolveProjection() const;
+    void updateTyped(int row, int col, const QString& value);
+    void setCell(int row, int col, const QString& value);
+    bool writeTo(QIODevice& device) const;
+    Snapshot captureSnapshot() const;
+    void indexSourceRows(qint64 size);
+    bool canSaveIncrementally() const;
+    bool refusesPartialSave(const QString& path);
+    bool saveIncremental();
+    bool saveSnapshot(const Snapshot& data, const QString& path, MetricsState* metrics);
+    QReadWriteLock* tableLock() const;
+    QReadWriteLock* shardLock(int row) const;
+    QReadWriteLock* shardLocks() const;
+    QMutex* indexLock() const;
+    void ensureSearchIndex() const;
+    void ensureSortedIndex() const;
+    // 排序索引的比较键：UTF-8 存储时直接比较字节（按码点），否则为 UTF-16 视图
+    QAnyStringView sortKey(quint64 cell) const;
+    QList<quint64> findCells(const QString& value) const;
+    void indexInsert(const QString& value, quint64 cell);
+    void indexRemove(const QString& value, quint64 cell);
+};
+
+// 追加写入器：不加载已有内容，把行直接追加到文件末尾。
+// 行按与保存相同的引号规则编码，先写入大块缓冲区再批量写入文件，耗时与文件已有大小无关。
+// 可选组提交：每累计若干行或每隔一段时间执行一次 fsync。单个追加器不是线程安全的。
+class QTCSV_EXPORT QCsvAppender {
+public:
+    struct Options {
+        char separator = ',';
+        qsizetype bufferSize = 4 * 1024 * 1024;  // 缓冲区满时才写入文件
+        int groupCommitRows = 0;                  // 每追加多少行 fsync 一次，0 表示不按行数
+        int groupCommitInterval = 0;              // 距上次 fsync 超过多少毫秒后，下一次追加时 fsync；0 表示不按时间
+    };
+
+    explicit QCsvAppender(const QString& filePath);
+    QCsvAppender(const QString& filePath, const Options& options);
+    ~QCsvAppender();
+
+    QCsvAppender(const QCsvAppender&) = delete;
+    QCsvAppender& operator=(const QCsvAppender&) = delete;
+
+    // 打开文件（不存在时创建）；已有内容不以换行结尾时先补一个换行
+    bool open();
+    // 写出缓冲区后关闭；启用了组提交时同时 fsync
+    void close();
+    bool isOpen() const { return writer != nullptr; }
+
+    bool appendRow(const std::vector<QString>& fields);
+    bool appendRow(const QStringList& fields);
+    bool appendRows(const QList<QStringList>& rows);
+
+    // 把缓冲区写入文件
+    bool flush();
+    // 写入文件并 fsync 到磁盘
+    bool sync();
+
+    qint64 rowsAppended() const { return rows; }
+    QString errorString() const { return lastError; }
+
+private:
+    QString filePath;
+    Options options;
+    std::unique_ptr<QFile> file;
+    std::unique_ptr<CsvWriter> writer;
+    qint64 rows = 0;
+    int rowsSinceSync = 0;
+    qint64 lastSync = 0;                          // 上次 fsync 的单调时钟毫秒数
+    QString lastError;
+
+    template<typename Fields>
+    bool appendFields(const Fields& fields);
+    bool groupCommitDue() const;
+};
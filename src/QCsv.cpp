@@ -1,505 +1,1247 @@
 #include "QCsv.hpp"
-#include <fstream>
+#include "QCsvFilter.hpp"
+#include "QCsvNumber.hpp"
+#include "QCsvSimd.hpp"
+#include "QCsvTokenizer.hpp"
+#include "QCsvWriter.hpp"
 #include <QDebug>
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <limits>
 #include <QFile>
 #include <QSaveFile>
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
-#include <QTextStream>
 #include <QStringBuilder>
+#include <QMetaMethod>
+#include <QThread>
+#include <QThreadPool>
+#include <QCache>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QRandomGenerator>
+#include <QStringDecoder>
+#include <QStringEncoder>
+#include <QVarLengthArray>
+#include <array>
+#include <cstring>
+#include <atomic>
+#include <unordered_set>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+// ==================== CsvStorage 实现 ====================
+
+namespace {
+
+// 调整向量大小，容量变化（重新分配）时计数
+template<typename Vector>
+void resizeCounted(Vector& vector, size_t size, qint64& allocations) {
+    const size_t capacity = vector.capacity();
+    vector.resize(size);
+    allocations += vector.capacity() != capacity;
+}
+
+} // namespace
+
+CsvStorage::Arena::Arena(const Arena& other)
+    : segments(other.segments.size()), usedChars(other.usedChars) {
+    slabs.reserve(other.slabs.size());
+    for (const Slab& source : other.slabs) {
+        Slab slab;
+        slab.data.reset(new char16_t[source.capacity]);
+        slab.first = source.first;
+        slab.count = source.count;
+        slab.capacity = source.capacity;
+        slab.used = source.used;
+        std::copy(source.data.get(), source.data.get() + source.used, slab.data.get());
+        for (quint32 i = 0; i < slab.count; ++i) {
+            segments[slab.first + i] = slab.data.get() + (qsizetype(i) << SLAB_SHIFT);
+        }
+        slabs.push_back(std::move(slab));
+    }
+}
 
-// ==================== CsvParser 实现 ====================
+void CsvStorage::Arena::reserve(qsizetype length, qint64& allocations) {
+    if (!slabs.empty() && slabs.back().capacity - slabs.back().used >= length) return;
 
-CsvParser::CsvParser(QHash<QString, QString>& csvModel, 
-                     QMultiMap<QString, QString>& searchModel,
-                     char separator)
-    : csvModel(csvModel), searchModel(searchModel), separator(separator) {}
+    // 超过一槽时按整槽向上取整，占用连续槽号，槽内地址仍可由槽号直接算出
+    const qsizetype count = std::max<qsizetype>(1, (length + SLAB_CHARS - 1) >> SLAB_SHIFT);
+    if (static_cast<qsizetype>(segments.size()) + count > (qsizetype(1) << (32 - SLAB_SHIFT))) {
+        throw std::length_error("CSV storage block exceeds 4G characters");
+    }
 
-void CsvParser::resetStatistics() {
-    stats = Statistics{};
+    Slab slab;
+    slab.capacity = count > 1 ? count << SLAB_SHIFT : length;
+    slab.data.reset(new char16_t[slab.capacity]);
+    slab.first = static_cast<quint32>(segments.size());
+    slab.count = static_cast<quint32>(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        segments.push_back(slab.data.get() + (i << SLAB_SHIFT));
+    }
+    slabs.push_back(std::move(slab));
+    ++allocations;
 }
 
-void CsvParser::processChar(char ch) {
-    switch (state) {
-        case STATE_NORMAL:
-            if (ch == '"') {
-                state = STATE_IN_QUOTES;
-            } else if (ch == separator) {
-                endCell();
-            } else if (ch == '\n') {
-                if (!pendingCR) {
-                    endCell();
-                    endRow();
-                }
-                pendingCR = false;
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endCell();
-                endRow();
-            } else {
-                currentCell.append(ch);
-            }
-            break;
-            
-        case STATE_IN_QUOTES:
-            if (ch == '"') {
-                state = STATE_QUOTE_IN_QUOTES;
-            } else {
-                currentCell.append(ch);
-            }
-            break;
-            
-        case STATE_QUOTE_IN_QUOTES:
-            if (ch == '"') {
-                currentCell.append('"');
-                state = STATE_IN_QUOTES;
-            } else if (ch == separator) {
-                endCell();
-                state = STATE_NORMAL;
-            } else if (ch == '\n') {
-                endCell();
-                endRow();
-                state = STATE_NORMAL;
-                pendingCR = false;
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endCell();
-                endRow();
-                state = STATE_NORMAL;
-            } else {
-                currentCell.append(ch);
-                state = STATE_NORMAL;
-            }
-            break;
-            
-        case STATE_END_OF_CELL:
-            if (ch == separator) {
-                endCell();
-            } else if (ch == '\n') {
-                endRow();
-                state = STATE_END_OF_ROW;
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endRow();
-                state = STATE_END_OF_ROW;
-            } else {
-                currentCell.append(ch);
-                state = STATE_NORMAL;
-            }
-            break;
-            
-        case STATE_END_OF_ROW:
-            if (ch == separator) {
-                endCell();
-                state = STATE_END_OF_CELL;
-            } else if (ch == '\n') {
-                endRow();
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endRow();
-            } else if (ch == '"') {
-                currentCell.append(ch);
-                state = STATE_IN_QUOTES;
-            } else {
-                currentCell.append(ch);
-                state = STATE_NORMAL;
-            }
-            break;
+quint32 CsvStorage::Arena::allocate(qsizetype length, qint64& allocations) {
+    if (slabs.empty() || slabs.back().capacity - slabs.back().used < length) {
+        const qsizetype next = slabs.empty() ? FIRST_SLAB_CHARS
+                                             : std::min(slabs.back().capacity * 2, SLAB_CHARS);
+        reserve(std::max(next, length), allocations);
     }
+
+    Slab& slab = slabs.back();
+    const quint32 offset = (slab.first << SLAB_SHIFT) + static_cast<quint32>(slab.used);
+    slab.used += length;
+    usedChars += length;
+    return offset;
 }
 
-void CsvParser::endCell() {
-    stats.maxCol = std::max(stats.maxCol, currentCol);
-    
-    if (!currentCell.isEmpty()) {
-        insertCell();
-        stats.totalCells++;
-    } else {
-        stats.emptyCells++;
+CsvStorage::CsvStorage(const CsvStorage& other) : utf8Native(other.utf8Native) {
+    // 共享的块不能再在读取时解码，先解码映射单元格；之后两份存储都不再引用映射
+    for (const auto& block : other.blocks) {
+        if (block && block->mapped) other.materialize(*block, other.utf8Native);
     }
-    
-    currentCell.clear();
-    currentCol++;
+    blocks = other.blocks;
 }
 
-void CsvParser::endRow() {
-    if (pendingCR) {
-        if (!currentCell.isEmpty()) {
-            endCell();
+CsvStorage& CsvStorage::operator=(const CsvStorage& other) {
+    if (this != &other) {
+        CsvStorage copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+int CsvStorage::Block::rowExtent() const {
+    size_t rows = 0;
+    for (const auto& spans : columns) {
+        rows = std::max(rows, spans.size());
+    }
+    return static_cast<int>(rows);
+}
+
+const CsvStorage::Span* CsvStorage::findSpan(int row, int col) const {
+    if (row < 0 || col < 0) return nullptr;
+
+    const size_t b = static_cast<size_t>(row) >> BLOCK_SHIFT;
+    if (b >= blocks.size() || !blocks[b]) return nullptr;
+
+    const Block& block = *blocks[b];
+    if (static_cast<size_t>(col) >= block.columns.size()) return nullptr;
+
+    const auto& spans = block.columns[col];
+    const size_t local = static_cast<size_t>(row) & (BLOCK_ROWS - 1);
+    if (local >= spans.size()) return nullptr;
+    return &spans[local];
+}
+
+CsvStorage::Span& CsvStorage::ensureSpan(int row, int col, Block*& block) {
+    const size_t b = static_cast<size_t>(row) >> BLOCK_SHIFT;
+    if (b >= blocks.size()) {
+        resizeCounted(blocks, b + 1, blockAllocations);
+    }
+    if (!blocks[b]) {
+        blocks[b] = std::make_shared<Block>();
+        ++blockAllocations;
+    }
+    block = detach(b);
+
+    if (static_cast<size_t>(col) >= block->columns.size()) {
+        resizeCounted(block->columns, col + 1, block->allocations);
+    }
+    auto& spans = block->columns[col];
+    const size_t local = static_cast<size_t>(row) & (BLOCK_ROWS - 1);
+    if (local >= spans.size()) {
+        // 前一块已写满说明在顺序写入大表，列数组直接按整块预留，避免逐行倍增
+        if (spans.capacity() == 0 && local == 0 && b > 0 && blocks[b - 1] &&
+            blocks[b - 1]->rowExtent() == BLOCK_ROWS) {
+            spans.reserve(BLOCK_ROWS);
+            ++block->allocations;
         }
-        pendingCR = false;
+        resizeCounted(spans, local + 1, block->allocations);
     }
-    
-    stats.maxRow = std::max(stats.maxRow, currentRow);
-    
-    currentRow++;
-    currentCol = 0;
+    return spans[local];
 }
 
-void CsvParser::insertCell() {
-    QString key = CsvUtils::numberToColumnRow(currentCol) % QString::number(currentRow + 1);
-    
-    stats.maxRow = std::max(stats.maxRow, currentRow + 1);
-    stats.maxCol = std::max(stats.maxCol, currentCol + 1);
+CsvStorage::Block* CsvStorage::detach(size_t b) {
+    if (blocks[b].use_count() > 1) {
+        blocks[b] = std::make_shared<Block>(*blocks[b]);
+        ++blocks[b]->allocations;
+    }
+    return blocks[b].get();
+}
 
-    if (!currentCell.isEmpty()) {
-        csvModel.insert(key, currentCell);
-        searchModel.insert(currentCell, key);
+void CsvStorage::prepareWrite(Block& block, Span& span) {
+    if (span.length & MAPPED) {
+        // 覆盖尚未解码的映射单元格，旧值无需解码
+        --block.mapped;
+        span = Span{};
+    } else if (span.length == 0) {
+        ++block.cells;
     }
 }
 
-void CsvParser::parse(const char* data, size_t size, bool isFinal) {
-    for (size_t i = 0; i < size; ++i) {
-        processChar(data[i]);
+void CsvStorage::materialize(Block& block, bool keepUtf8) const {
+    auto selected = [keepUtf8](const Span& span) {
+        return (span.length & MAPPED) || (!keepUtf8 && (span.length & UTF8));
+    };
+
+    qsizetype units = 0;
+    for (const auto& spans : block.columns) {
+        for (const Span& span : spans) {
+            if (selected(span)) units += keepUtf8 ? (byteCount(span) + 1) / 2 : byteCount(span);
+        }
     }
-    
-    if (isFinal) {
-        finalize();
+    block.heap.reserve(units, block.allocations);  // UTF-16 单元数不超过 UTF-8 字节数
+
+    for (auto& spans : block.columns) {
+        for (Span& span : spans) {
+            if (!selected(span)) continue;
+            // 旧值的字节可能在 Span 内或字符堆中，先让出位置，避免被新值原地覆盖
+            const Span old = span;
+            const char* data = utf8Data(block, old);
+            block.garbage += heapUnits(old);
+            span = Span{};
+            if (keepUtf8) {
+                writeBytes(block, span, data, byteCount(old));
+            } else {
+                writeUtf8(block, span, data, byteCount(old));
+            }
+        }
     }
+    block.mapped = 0;
 }
 
-void CsvParser::finalize() {
-    if (state == STATE_IN_QUOTES) {
-        qWarning() << "CSV file ended inside quoted field";
+char16_t* CsvStorage::allocate(Block& block, Span& span, qsizetype length) {
+    if (length > static_cast<qsizetype>(LENGTH_MASK)) {
+        throw std::length_error("CSV cell exceeds 1G characters");
     }
-    
-    if (!currentCell.isEmpty() || state != STATE_NORMAL) {
-        endCell();
+
+    const qsizetype old = heapUnits(span);
+    if (length <= static_cast<qsizetype>(INLINE_CHARS)) {
+        block.garbage += old;
+        span = Span{};
+        span.length = static_cast<quint32>(length);
+        return span.text;
     }
-    
-    if (currentCol > 0) {
-        endRow();
+
+    // 新值不长于旧值时原地覆盖，否则追加到字符堆
+    if (length <= old) {
+        block.garbage += old - length;
+        span.length = static_cast<quint32>(length);
+        return block.heap.data(span.offset);
     }
-}
 
-// ==================== Utf8CsvParser 实现 ====================
+    block.garbage += old;
+    span.offset = block.heap.allocate(length, block.allocations);
+    span.length = static_cast<quint32>(length);
+    return block.heap.data(span.offset);
+}
 
-Utf8CsvParser::Utf8CsvParser(QHash<QString, QString>& csvModel, 
-                             QMultiMap<QString, QString>& searchModel,
-                             char separator)
-    : csvModel(csvModel), searchModel(searchModel), separator(separator) {
-        currentCell.reserve(256);  // 预分配空间
-        utf8Buffer.reserve(8);  
+void CsvStorage::compact(Block& block) {
+    Arena heap;
+    heap.reserve(block.heap.used() - block.garbage, block.allocations);
+    for (auto& spans : block.columns) {
+        for (Span& span : spans) {
+            const qsizetype units = heapUnits(span);
+            if (units == 0) continue;
+            const char16_t* src = block.heap.data(span.offset);
+            const quint32 offset = heap.allocate(units, block.allocations);
+            std::copy(src, src + units, heap.data(offset));
+            span.offset = offset;
+        }
     }
+    block.heap = std::move(heap);
+    block.garbage = 0;
+}
 
-void Utf8CsvParser::resetStatistics() {
-    stats = Statistics{};
+QStringView CsvStorage::view(int row, int col) const {
+    const Span* span = findSpan(row, col);
+    if (!span || span->length == 0) return QStringView();
+
+    // 整块解码，之后同一块内的读取不再解码
+    Block& block = *blocks[static_cast<size_t>(row) >> BLOCK_SHIFT];
+    if (block.mapped || (span->length & UTF8)) materialize(block);
+    return QStringView(chars(block, *span), span->length);
 }
 
-void Utf8CsvParser::processChar(QChar ch) {
-    // 原有 CsvParser 的 processChar 逻辑，但处理 QChar
-    char ascii = ch.toLatin1();
-    
-    switch (state) {
-        case STATE_NORMAL:
-            if (ch == '"') {
-                state = STATE_IN_QUOTES;
-            } else if (ascii == separator) {
-                endCell();
-            } else if (ch == '\n') {
-                if (!pendingCR) {
-                    endCell();
-                    endRow();
-                }
-                pendingCR = false;
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endCell();
-                endRow();
-            } else {
-                currentCell.append(ch);
-            }
-            break;
-            
-        case STATE_IN_QUOTES:
-            if (ch == '"') {
-                state = STATE_QUOTE_IN_QUOTES;
-            } else {
-                currentCell.append(ch);
-            }
-            break;
-            
-        case STATE_QUOTE_IN_QUOTES:
-            if (ch == '"') {
-                currentCell.append('"');
-                state = STATE_IN_QUOTES;
-            } else if (ascii == separator) {
-                endCell();
-                state = STATE_NORMAL;
-            } else if (ch == '\n') {
-                endCell();
-                endRow();
-                state = STATE_NORMAL;
-                pendingCR = false;
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endCell();
-                endRow();
-                state = STATE_NORMAL;
-            } else {
-                currentCell.append(ch);
-                state = STATE_NORMAL;
-            }
-            break;
-            
-        case STATE_END_OF_CELL:
-            if (ascii == separator) {
-                endCell();
-            } else if (ch == '\n') {
-                endRow();
-                state = STATE_END_OF_ROW;
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endRow();
-                state = STATE_END_OF_ROW;
-            } else {
-                currentCell.append(ch);
-                state = STATE_NORMAL;
-            }
-            break;
-            
-        case STATE_END_OF_ROW:
-            if (ascii == separator) {
-                endCell();
-                state = STATE_END_OF_CELL;
-            } else if (ch == '\n') {
-                endRow();
-            } else if (ch == '\r') {
-                pendingCR = true;
-                endRow();
-            } else if (ch == '"') {
-                currentCell.append(ch);
-                state = STATE_IN_QUOTES;
-            } else {
-                currentCell.append(ch);
-                state = STATE_NORMAL;
-            }
-            break;
+QString CsvStorage::value(int row, int col) const {
+    return visit(row, col, [](QStringView value, const char* utf8, qsizetype size) {
+        return utf8 ? QString::fromUtf8(utf8, size) : value.toString();
+    });
+}
+
+QAnyStringView CsvStorage::storedView(int row, int col) const {
+    return visit(row, col, [](QStringView value, const char* utf8, qsizetype size) -> QAnyStringView {
+        if (utf8) return QUtf8StringView(utf8, size);
+        return value;
+    });
+}
+
+QStringView CsvStorage::decode(std::vector<char16_t>& buffer, const char* data, qsizetype size) {
+    if (buffer.size() < static_cast<size_t>(size)) buffer.resize(static_cast<size_t>(size));
+    if (CsvSimd::isAscii(data, data + size)) {
+        for (qsizetype i = 0; i < size; ++i) {
+            buffer[i] = static_cast<unsigned char>(data[i]);
+        }
+        return QStringView(buffer.data(), size);
     }
+    QStringDecoder decoder(QStringConverter::Utf8, QStringConverter::Flag::Stateless);
+    QChar* const out = reinterpret_cast<QChar*>(buffer.data());
+    return QStringView(buffer.data(), decoder.appendToBuffer(out, QByteArrayView(data, size)) - out);
 }
 
-void Utf8CsvParser::flushUtf8Char() {
-    if (!utf8Buffer.isEmpty()) {
-        QString str = QString::fromUtf8(utf8Buffer);
-        for (QChar ch : str) {
-            processChar(ch);
+void CsvStorage::setValue(int row, int col, QStringView value) {
+    if (row < 0 || col < 0) return;
+
+    if (value.isEmpty()) {
+        const Span* found = findSpan(row, col);
+        if (!found || found->length == 0) return;
+
+        Block& block = *detach(static_cast<size_t>(row) >> BLOCK_SHIFT);
+        Span& span = block.columns[col][static_cast<size_t>(row) & (BLOCK_ROWS - 1)];
+        if (span.length & MAPPED) {
+            --block.mapped;
+        } else {
+            block.garbage += heapUnits(span);
         }
-        utf8Buffer.clear();
+        span = Span{};
+        --block.cells;
+        return;
+    }
+
+    if (utf8Native) {
+        // 先编码到栈上缓冲区：源数据可能就在本存储中
+        QVarLengthArray<char, 256> encoded(value.size() * 3);
+        QStringEncoder encoder(QStringConverter::Utf8, QStringConverter::Flag::Stateless);
+        const qsizetype size = encoder.appendToBuffer(encoded.data(), value) - encoded.data();
+        setUtf8(row, col, encoded.data(), size);
+        return;
+    }
+
+    // 源数据可能是本存储中的内联值，列数组扩容会移动它，先复制出来；字符堆中的数据不会移动
+    const char16_t* src = value.utf16();
+    char16_t shortValue[INLINE_CHARS];
+    if (value.size() <= INLINE_CHARS) {
+        std::copy(src, src + value.size(), shortValue);
+        src = shortValue;
+    }
+
+    Block* block = nullptr;
+    Span& span = ensureSpan(row, col, block);
+    prepareWrite(*block, span);
+    char16_t* dst = allocate(*block, span, value.size());
+    std::copy(src, src + value.size(), dst);
+
+    if (block->garbage > 4096 && block->garbage * 2 > block->heap.used()) {
+        compact(*block);
     }
 }
 
-void Utf8CsvParser::processUtf8Char(const char*& ptr, const char* end) {
-    unsigned char c = *ptr++;
-    
-    if (c < 0x80) {
-        // ASCII 字符，直接处理
-        flushUtf8Char();  // 先刷新可能存在的UTF-8缓冲区
-        processChar(QChar::fromLatin1(static_cast<char>(c)));
+void CsvStorage::setUtf8(int row, int col, const char* data, qsizetype size) {
+    if (row < 0 || col < 0) return;
+
+    if (size == 0) {
+        remove(row, col);
         return;
     }
-    
-    // UTF-8 多字节字符开始
-    utf8Buffer.append(static_cast<char>(c));
-    
-    // 确定UTF-8字符的字节数
-    int bytesNeeded = 1;
-    if ((c & 0xE0) == 0xC0) {
-        bytesNeeded = 2;  // 2字节字符: 110xxxxx 10xxxxxx
-    } else if ((c & 0xF0) == 0xE0) {
-        bytesNeeded = 3;  // 3字节字符: 1110xxxx 10xxxxxx 10xxxxxx
-    } else if ((c & 0xF8) == 0xF0) {
-        bytesNeeded = 4;  // 4字节字符: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+
+    Block* block = nullptr;
+    Span& span = ensureSpan(row, col, block);
+    prepareWrite(*block, span);
+    store(*block, span, data, size);
+
+    if (block->garbage > 4096 && block->garbage * 2 > block->heap.used()) {
+        compact(*block);
+    }
+}
+
+void CsvStorage::writeUtf8(Block& block, Span& span, const char* data, qsizetype size) {
+    if (CsvSimd::isAscii(data, data + size)) {
+        // ASCII 快速路径：逐字节扩展写入堆
+        char16_t* dst = allocate(block, span, size);
+        for (qsizetype i = 0; i < size; ++i) {
+            dst[i] = static_cast<unsigned char>(data[i]);
+        }
+        return;
+    }
+
+    // 先解码到栈上缓冲区，得到准确长度后再分配，短值仍可内联
+    QVarLengthArray<QChar, 256> decoded(size);
+    block.allocations += size > 256;
+    QStringDecoder decoder(QStringConverter::Utf8, QStringConverter::Flag::Stateless);
+    const qsizetype length = decoder.appendToBuffer(decoded.data(), QByteArrayView(data, size)) - decoded.data();
+    char16_t* dst = allocate(block, span, length);
+    const char16_t* src = reinterpret_cast<const char16_t*>(decoded.data());
+    std::copy(src, src + length, dst);
+}
+
+void CsvStorage::writeBytes(Block& block, Span& span, const char* data, qsizetype size) {
+    if (size > static_cast<qsizetype>(LENGTH_MASK)) {
+        throw std::length_error("CSV cell exceeds 1G bytes");
+    }
+
+    // 字节按 UTF-16 单元占用字符堆，与 UTF-16 值共用原地覆盖和压缩逻辑
+    char* dst;
+    if (size <= static_cast<qsizetype>(INLINE_BYTES)) {
+        block.garbage += heapUnits(span);
+        span = Span{};
+        dst = span.bytes;
     } else {
-        // 无效的UTF-8起始字节，当作ASCII处理
-        flushUtf8Char();
-        processChar(QChar::fromLatin1(static_cast<char>(c)));
+        dst = reinterpret_cast<char*>(allocate(block, span, (size + 1) / 2));
+    }
+    std::memcpy(dst, data, static_cast<size_t>(size));
+    span.length = static_cast<quint32>(size) | UTF8;
+}
+
+void CsvStorage::setMapped(int row, int col, const char* data, qsizetype size) {
+    if (row < 0 || col < 0) return;
+
+    Block* block = nullptr;
+    Span& span = ensureSpan(row, col, block);
+    const qint64 offset = data - mapping.get();
+    if (block->mappedBase < 0) {
+        block->mappedBase = offset;
+    }
+
+    // 偏移或长度超出 Span 的表示范围时退回立即写入
+    const qint64 relative = offset - block->mappedBase;
+    if (span.length != 0 || relative < 0 || size > static_cast<qsizetype>(LENGTH_MASK) ||
+        relative + size > std::numeric_limits<quint32>::max()) {
+        prepareWrite(*block, span);
+        store(*block, span, data, size);
         return;
     }
-    
-    // 读取剩余的字节
-    for (int i = 1; i < bytesNeeded && ptr < end; ++i) {
-        utf8Buffer.append(*ptr++);
+
+    span.offset = static_cast<quint32>(relative);
+    span.length = static_cast<quint32>(size) | MAPPED;
+    ++block->mapped;
+    ++block->cells;
+}
+
+void CsvStorage::releaseMapping() {
+    for (const auto& block : blocks) {
+        if (block && block->mapped) materialize(*block, utf8Native);
     }
-    
-    // 如果收集了完整的UTF-8字符，转换为QChar并处理
-    if (utf8Buffer.size() == bytesNeeded) {
-        flushUtf8Char();
+    mapping.reset();
+}
+
+void CsvStorage::merge(CsvStorage&& other) {
+    if (other.blocks.size() > blocks.size()) {
+        resizeCounted(blocks, other.blocks.size(), blockAllocations);
+    }
+    if (!mapping) {
+        mapping = other.mapping;
+    }
+    blockAllocations += other.blockAllocations;
+    const bool sameMapping = mapping == other.mapping;
+
+    for (size_t b = 0; b < other.blocks.size(); ++b) {
+        std::shared_ptr<Block>& source = other.blocks[b];
+        if (!source) continue;
+        if (source->mapped && (!sameMapping || blocks[b])) {
+            other.materialize(*source, utf8Native);
+        }
+
+        if (!blocks[b]) {
+            blocks[b] = std::move(source);
+            continue;
+        }
+
+        // 两份存储共享同一个块，逐单元格复制
+        const int baseRow = static_cast<int>(b) << BLOCK_SHIFT;
+        for (size_t col = 0; col < source->columns.size(); ++col) {
+            const auto& spans = source->columns[col];
+            for (size_t local = 0; local < spans.size(); ++local) {
+                const Span& span = spans[local];
+                if (span.length == 0) continue;
+                const int row = baseRow + static_cast<int>(local);
+                if (const char* utf8 = other.utf8Data(*source, span)) {
+                    setUtf8(row, static_cast<int>(col), utf8, byteCount(span));
+                } else {
+                    setValue(row, static_cast<int>(col), QStringView(chars(*source, span), span.length));
+                }
+            }
+        }
     }
-    // 否则等待更多数据
+    other.clear();
 }
 
-void Utf8CsvParser::parse(const char* data, size_t size, bool isFinal) {
-    const char* ptr = data;
-    const char* end = data + size;
-    
-    while (ptr < end) {
-        processUtf8Char(ptr, end);
+void CsvStorage::clear() {
+    blocks.clear();
+    blocks.shrink_to_fit();
+    mapping.reset();
+    blockAllocations = 0;
+}
+
+qint64 CsvStorage::allocationCount() const {
+    qint64 count = blockAllocations;
+    for (const auto& block : blocks) {
+        if (block) count += block->allocations;
+    }
+    return count;
+}
+
+qsizetype CsvStorage::size() const {
+    qsizetype cells = 0;
+    for (const auto& block : blocks) {
+        if (block) cells += block->cells;
+    }
+    return cells;
+}
+
+// ==================== CsvParser 实现 ====================
+
+CsvParser::CsvParser(CsvStorage& storage, 
+                     QMultiMap<QString, quint64>& searchModel,
+                     char separator)
+    : storage(storage), searchModel(searchModel), separator(separator) {
+        cellBytes.reserve(256);
     }
+
+void CsvParser::resetStatistics() {
+    stats = Statistics{};
+}
+
+void CsvParser::parse(const char* data, size_t size, bool isFinal) {
+    struct Sink {
+        CsvParser& parser;
+        void append(const char* begin, const char* end) { parser.cellBytes.append(begin, end - begin); }
+        void quoted() {}
+        void field(const char* begin, const char* end) { parser.endCell(begin, end); }
+        bool row(const char*, bool) { parser.endRow(); return false; }
+        void crlf(const char*) {}
+    } sink{*this};
+
+    const char* const end = data + size;
+    CsvTokenizer::withDialect(separator, [&](auto dialect) {
+        for (const char* window = data; window < end; ) {
+            const char* windowEnd = window + std::min<size_t>(end - window, WINDOW_SIZE);
+            structural.clear();
+            CsvSimd::findStructural(window, windowEnd, separator, structural);
+            CsvTokenizer::tokenizeWindow(dialect, state, pendingCR, window, windowEnd, structural, sink);
+            window = windowEnd;
+        }
+    });
     
     if (isFinal) {
-        // 处理最后一个可能的UTF-8字符
-        flushUtf8Char();
         finalize();
     }
 }
 
-void Utf8CsvParser::finalize() {
-    if (state == STATE_IN_QUOTES) {
+void CsvParser::finalize() {
+    if (state == CsvQuoteState::InQuotes) {
         qWarning() << "CSV file ended inside quoted field";
     }
     
-    flushUtf8Char();
-    
-    if (!currentCell.isEmpty() || state != STATE_NORMAL) {
-        endCell();
+    if (!cellBytes.isEmpty() || state != CsvQuoteState::Normal) {
+        endCell(nullptr, nullptr);
     }
     
     if (currentCol > 0) {
         endRow();
     }
+
+    state = CsvQuoteState::Normal;
+    pendingCR = false;
 }
 
-void Utf8CsvParser::endCell() {
+void CsvParser::endCell(const char* begin, const char* end) {
     stats.maxCol = std::max(stats.maxCol, currentCol);
     
-    if (!currentCell.isEmpty()) {
-        insertCell();
+    cellBytes.append(begin, end - begin);
+    if (!cellBytes.isEmpty()) {
+        const QString value = QString::fromUtf8(cellBytes);
+        storage.setValue(currentRow, currentCol, value);
+        searchModel.insert(value, CsvUtils::packCell(currentRow, currentCol));
+        stats.maxRow = std::max(stats.maxRow, currentRow + 1);
+        stats.maxCol = std::max(stats.maxCol, currentCol + 1);
         stats.totalCells++;
     } else {
         stats.emptyCells++;
     }
     
-    currentCell.clear();
+    cellBytes.resize(0);  // 保留容量
     currentCol++;
 }
 
-void Utf8CsvParser::endRow() {
-    if (pendingCR) {
-        if (!currentCell.isEmpty()) {
-            endCell();
-        }
-        pendingCR = false;
-    }
-    
+void CsvParser::endRow() {
     stats.maxRow = std::max(stats.maxRow, currentRow);
     
     currentRow++;
     currentCol = 0;
 }
 
-void Utf8CsvParser::insertCell() {
-    QString key = CsvUtils::numberToColumnRow(currentCol) % QString::number(currentRow + 1);
-    
-    stats.maxRow = std::max(stats.maxRow, currentRow + 1);
-    stats.maxCol = std::max(stats.maxCol, currentCol + 1);
+// ==================== Utf8CsvParser 实现 ====================
 
-    if (!currentCell.isEmpty()) {
-        csvModel.insert(key, currentCell);
-        searchModel.insert(currentCell, key);
+Utf8CsvParser::Utf8CsvParser(CsvStorage& storage, char separator)
+    : storage(storage), separator(separator) {
+        cellBytes.reserve(256);  // 预分配空间
+        structural.reserve(64 * 1024);
     }
-}
-
-// ==================== QCsv 实现 ====================
 
-QCsv::QCsv(const QString& filePath, QObject* parent)
-    : QObject(parent), filePath(filePath) {
-    try {
-        open(filePath);
-    } catch (const std::exception& e) {
-        emit error(tr("Failed to open file: %1").arg(e.what()));
-    }
+void Utf8CsvParser::resetStatistics() {
+    stats = Statistics{};
 }
 
-QCsv::~QCsv() {
-    try {
-        closeStream();
-    } catch (const std::exception& e) {
-        qWarning() << "Error in QCsv destructor:" << e.what();
+void Utf8CsvParser::setRowIndex(std::vector<quint64>* offsets, const char* base) {
+    rowIndex = offsets;
+    indexBase = base;
+    if (rowIndex) {
+        rowIndex->assign(1, 0);
     }
 }
 
-QCsv::QCsv(QCsv&& other) noexcept
-    : QObject(other.parent()),
-      filePath(std::move(other.filePath)),
-      csvModel(std::move(other.csvModel)),
-      searchModel(std::move(other.searchModel)),
-      separator(other.separator),
-      opened(other.opened),
-      fileStream(std::move(other.fileStream)),
-      currentRow(other.currentRow),
-      currentCol(other.currentCol),
-      currentCell(std::move(other.currentCell)),
-      state(other.state),
-      pendingCR(other.pendingCR),
-      atEnd(other.atEnd) {
-    
-    // 完全重置原对象的状态
-    other.opened = false;
-    other.currentRow = 0;
-    other.currentCol = 0;
-    other.currentCell.clear();
-    other.state = CsvParser::STATE_NORMAL;
-    other.pendingCR = false;
-    other.atEnd = true;  // 设置为已结束
+void Utf8CsvParser::setProjection(const std::vector<int>* columns) {
+    projection = columns;
+    setColumn(currentCol);
 }
 
-QCsv& QCsv::operator=(QCsv&& other) noexcept {
-    if (this != &other) {
-        setParent(other.parent());
-        filePath = std::move(other.filePath);
-        csvModel = std::move(other.csvModel);
-        searchModel = std::move(other.searchModel);
-        separator = other.separator;
-        opened = other.opened;
-        fileStream = std::move(other.fileStream);
-        currentRow = other.currentRow;
-        currentCol = other.currentCol;
-        currentCell = std::move(other.currentCell);
-        state = other.state;
-        pendingCR = other.pendingCR;
-        atEnd = other.atEnd;
+void Utf8CsvParser::parse(const char* data, size_t size, bool isFinal) {
+    const char* const end = data + size;
+    stats.bytes += static_cast<qint64>(size);
 
-        other.filePath.clear();
-        other.opened = false;
-        other.currentRow = 0;
-        other.currentCol = 0;
-        other.currentCell.clear();
-        other.state = CsvParser::STATE_NORMAL;
-        other.pendingCR = false;
-        other.atEnd = true;
+    QElapsedTimer timer;
+    if (timing) timer.start();
+    const qint64 tokenizeBefore = stats.tokenizeNs;
+    
+    // 按窗口处理，保证结构字符偏移可用 32 位表示且索引常驻缓存
+    for (const char* window = data; window < end; ) {
+        const char* windowEnd = window + std::min<size_t>(end - window, WINDOW_SIZE);
+        parseWindow(window, windowEnd);
+        window = windowEnd;
     }
-    return *this;
-}
 
-void QCsv::open(const QString& filePath) {
-    if (filePath.isEmpty()) {
-        throw std::runtime_error("File path cannot be empty");
+    if (timing) {
+        stats.insertNs += timer.nsecsElapsed() - (stats.tokenizeNs - tokenizeBefore);
     }
     
-    this->filePath = filePath;
-    QFile file(filePath);
-    
-    if (!file.exists()) {
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            throw std::runtime_error("Could not create file: " + filePath.toStdString());
-        }
-        file.close();
+    if (isFinal) {
+        finalize();
     }
-    
-    opened = true;
-    emit fileOpened(filePath);
 }
 
-void QCsv::close() {
-    if (!isOpen()) {
-        throw std::runtime_error("File is not open");
+void Utf8CsvParser::parseWindow(const char* begin, const char* end) {
+    structural.clear();
+    if (timing) {
+        QElapsedTimer timer;
+        timer.start();
+        CsvSimd::findStructural(begin, end, separator, structural);
+        stats.tokenizeNs += timer.nsecsElapsed();
+    } else {
+        CsvSimd::findStructural(begin, end, separator, structural);
     }
-    opened = false;
-    clear();
-    closeStream();
+
+    struct Sink {
+        Utf8CsvParser& parser;
+        void append(const char* begin, const char* end) {
+            if (!parser.skipCell) parser.cellBytes.append(begin, end - begin);
+        }
+        void quoted() { parser.stats.quotedCells++; }
+        void field(const char* begin, const char* end) { parser.endCell(begin, end); }
+        bool row(const char* next, bool) {
+            parser.endRow();
+            if (parser.rowIndex) parser.rowIndex->push_back(next - parser.indexBase);
+            return false;
+        }
+        void crlf(const char* next) {
+            if (parser.rowIndex) parser.rowIndex->back() = next - parser.indexBase;  // 下一行从 LF 之后开始
+        }
+    } sink{*this};
+
+    CsvTokenizer::withDialect(separator, [&](auto dialect) {
+        CsvTokenizer::tokenizeWindow(dialect, state, pendingCR, begin, end, structural, sink);
+    });
+}
+
+void Utf8CsvParser::finalize() {
+    if (state == CsvQuoteState::InQuotes) {
+        qWarning() << "CSV file ended inside quoted field";
+    }
+    
+    if (!cellBytes.isEmpty() || state != CsvQuoteState::Normal) {
+        endCell(nullptr, nullptr);
+    }
+    
+    if (currentCol > 0) {
+        endRow();
+    }
+
+    state = CsvQuoteState::Normal;
+    pendingCR = false;
+}
+
+void Utf8CsvParser::endCell(const char* begin, const char* end) {
+    if (skipCell) {
+        setColumn(currentCol + 1);
+        return;
+    }
+    const int col = projection ? (*projection)[currentCol] : currentCol;
+    stats.maxCol = std::max(stats.maxCol, col);
+    
+    // 字段完全位于当前窗口且无转义时直接从输入解码，否则先拼接
+    const char* data = begin;
+    qsizetype size = end - begin;
+    const bool direct = cellBytes.isEmpty();
+    if (!direct) {
+        cellBytes.append(begin, size);
+        data = cellBytes.constData();
+        size = cellBytes.size();
+    }
+
+    if (size > 0) {
+        insertCell(col, data, size, direct);
+        stats.totalCells++;
+    } else {
+        stats.emptyCells++;
+    }
+    
+    cellBytes.resize(0);  // 保留容量
+    setColumn(currentCol + 1);
+}
+
+void Utf8CsvParser::endRow() {
+    stats.maxRow = std::max(stats.maxRow, currentRow);
+    
+    currentRow++;
+    setColumn(0);
+}
+
+void Utf8CsvParser::setColumn(int col) {
+    currentCol = col;
+    skipCell = projection && (static_cast<size_t>(col) >= projection->size() || (*projection)[col] < 0);
+}
+
+void Utf8CsvParser::insertCell(int col, const char* data, qsizetype size, bool direct) {
+    stats.maxRow = std::max(stats.maxRow, currentRow + 1);
+    stats.maxCol = std::max(stats.maxCol, col + 1);
+    if (rowIndex) return;
+
+    if (zeroCopy && direct) {
+        storage.setMapped(currentRow, col, data, size);
+    } else {
+        storage.setUtf8(currentRow, col, data, size);
+    }
+}
+
+// ==================== QCsv 实现 ====================
+
+struct QCsv::LazyRows {
+    std::shared_ptr<const char> source;     // 文件映射（或整体读入的内容）
+    qint64 size = 0;
+    std::vector<quint64> offsets;           // 每行起始偏移
+    std::vector<bool> loaded;               // 已转入 storage 的行（被修改过）
+    qsizetype cells = 0;                    // 非空单元格数
+    QCache<int, QStringList> cache;         // 最近解析的行
+};
+
+struct QCsv::SearchIndex {
+    SearchIndexKind kind = SearchIndexKind::Ordered;
+    bool built = false;                     // ordered / hash 是否已建立
+    bool sortedValid = false;
+    QMultiMap<QString, quint64> ordered;
+    QMultiHash<QString, quint64> hash;
+    std::vector<quint64> sorted;            // 按 (值, 单元格) 排序的单元格
+
+    void reset() {
+        built = false;
+        sortedValid = false;
+        ordered.clear();
+        hash.clear();
+        sorted.clear();
+        sorted.shrink_to_fit();
+    }
+};
+
+struct QCsv::SourceRows {
+    qint64 size = 0;                        // 加载（或上次增量保存）时的文件大小与修改时间
+    QDateTime modified;
+    char separator = ',';
+    std::vector<quint64> offsets;           // 每行起始偏移
+    std::vector<quint8> dirty;              // 被修改过的行；按字节存放，不同分片并发写入互不干扰
+    QMutex saving;                          // 增量保存互斥（保存期间只持有读锁）
+};
+
+namespace {
+
+// 映射中尚未解码的 ASCII 单元格（deferDecode），类型推断直接解析原始字节
+struct AsciiBytes {
+    const char* data;
+    qsizetype size;
+};
+
+bool parseInt64(QStringView value, qint64& out) {
+    return CsvNumber::parseInt64(value, out);
+}
+
+bool parseInt64(AsciiBytes value, qint64& out) {
+    return CsvNumber::parseInt64(value.data, value.data + value.size, out);
+}
+
+bool parseDouble(QStringView value, double& out) {
+    return CsvNumber::parseDouble(value, out);
+}
+
+bool parseDouble(AsciiBytes value, double& out) {
+    return CsvNumber::parseDouble(value.data, value.data + value.size, out);
+}
+
+bool parseBool(QStringView value, bool& out) {
+    if (value.compare(QStringView(u"true"), Qt::CaseInsensitive) == 0) {
+        out = true;
+        return true;
+    }
+    if (value.compare(QStringView(u"false"), Qt::CaseInsensitive) == 0) {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+bool equalsIgnoreCase(AsciiBytes value, const char* word) {
+    for (qsizetype i = 0; i < value.size; ++i) {
+        const char c = value.data[i];
+        if (!word[i] || (c >= 'A' && c <= 'Z' ? char(c + 32) : c) != word[i]) return false;
+    }
+    return !word[value.size];
+}
+
+bool parseBool(AsciiBytes value, bool& out) {
+    if (equalsIgnoreCase(value, "true")) {
+        out = true;
+        return true;
+    }
+    if (equalsIgnoreCase(value, "false")) {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+// 只接受 yyyy-MM-dd，存为儒略日
+bool parseDate(QStringView value, qint64& out) {
+    if (value.size() != 10) return false;
+    const QDate date = QDate::fromString(value, Qt::ISODate);
+    if (!date.isValid()) return false;
+    out = date.toJulianDay();
+    return true;
+}
+
+bool parseDate(AsciiBytes value, qint64& out) {
+    if (value.size != 10) return false;
+    return parseDate(QStringView(QString::fromLatin1(value.data, value.size)), out);
+}
+
+// 类型推断中仍然可能的类型
+enum TypeCandidate : quint8 {
+    CAN_INT64 = 1,
+    CAN_DOUBLE = 2,
+    CAN_BOOL = 4,
+    CAN_DATE = 8,
+    CAN_ANY = CAN_INT64 | CAN_DOUBLE | CAN_BOOL | CAN_DATE
+};
+
+// 返回 mask 中 value 能解析成的类型
+template<typename Text>
+quint8 classify(Text value, quint8 mask) {
+    quint8 result = 0;
+    qint64 integer = 0;
+    double number = 0;
+    bool flag = false;
+    if ((mask & CAN_INT64) && parseInt64(value, integer)) {
+        result |= CAN_INT64 | CAN_DOUBLE;
+    } else if ((mask & CAN_DOUBLE) && parseDouble(value, number)) {
+        result |= CAN_DOUBLE;
+    }
+    if ((mask & CAN_BOOL) && parseBool(value, flag)) result |= CAN_BOOL;
+    if ((mask & CAN_DATE) && parseDate(value, integer)) result |= CAN_DATE;
+    return result & mask;
+}
+
+QCsv::ColumnType typeFor(quint8 candidates) {
+    if (candidates & CAN_INT64) return QCsv::ColumnType::Int64;
+    if (candidates & CAN_DOUBLE) return QCsv::ColumnType::Double;
+    if (candidates & CAN_BOOL) return QCsv::ColumnType::Bool;
+    if (candidates & CAN_DATE) return QCsv::ColumnType::Date;
+    return QCsv::ColumnType::String;
+}
+
+} // namespace
+
+struct QCsv::TypedColumns {
+    struct Column {
+        ColumnType inferred = ColumnType::String;           // 加载时推断的类型，决定分配了哪些数组
+        std::atomic<ColumnType> type{ColumnType::String};  // 当前类型；写入不符的值后退化为 String，数组保留到下次加载
+        std::vector<qint64> ints;                           // Int64、Bool（0/1）、Date（儒略日）
+        std::vector<double> doubles;                        // Int64、Double、Bool
+        std::vector<quint64> valid;                         // 非空位图，64 行一个字，不跨分片
+
+        bool usesInts() const { return inferred == ColumnType::Int64 || inferred == ColumnType::Bool || inferred == ColumnType::Date; }
+        bool usesDoubles() const { return inferred == ColumnType::Int64 || inferred == ColumnType::Double || inferred == ColumnType::Bool; }
+        // 数值读取、聚合与区间过滤只走 Int64、Double 列：Bool 的 0/1 与 Date 的儒略日在字符串路径上
+        // 不能解析为数字，走原生数组会让结果取决于是否推断了类型
+        bool isNumeric() const { return inferred == ColumnType::Int64 || inferred == ColumnType::Double; }
+        size_t rows() const { return usesInts() ? ints.size() : doubles.size(); }
+        bool has(int row) const { return (valid[row >> 6] >> (row & 63)) & 1; }
+
+        void resize(size_t count) {
+            valid.resize((count + 63) / 64);
+            if (usesInts()) ints.resize(count);
+            if (usesDoubles()) doubles.resize(count);
+        }
+
+        // 解析失败时返回 false，不修改
+        template<typename Text>
+        bool store(int row, Text value) {
+            qint64 integer = 0;
+            double number = 0;
+            bool flag = false;
+            switch (inferred) {
+                case ColumnType::Int64:
+                    if (!parseInt64(value, integer)) return false;
+                    ints[row] = integer;
+                    doubles[row] = static_cast<double>(integer);
+                    break;
+                case ColumnType::Double:
+                    if (!parseDouble(value, number)) return false;
+                    doubles[row] = number;
+                    break;
+                case ColumnType::Bool:
+                    if (!parseBool(value, flag)) return false;
+                    ints[row] = flag ? 1 : 0;
+                    doubles[row] = flag ? 1.0 : 0.0;
+                    break;
+                case ColumnType::Date:
+                    if (!parseDate(value, integer)) return false;
+                    ints[row] = integer;
+                    break;
+                default:
+                    return false;
+            }
+            valid[row >> 6] |= quint64(1) << (row & 63);
+            return true;
+        }
+
+        void erase(int row) {
+            valid[row >> 6] &= ~(quint64(1) << (row & 63));
+            if (usesInts()) ints[row] = 0;
+            if (usesDoubles()) doubles[row] = 0;
+        }
+    };
+
+    explicit TypedColumns(int count) : columns(static_cast<size_t>(count)) {}
+
+    // 当前仍为类型化的列，否则返回 nullptr
+    const Column* find(int col) const {
+        if (col < 0 || static_cast<size_t>(col) >= columns.size()) return nullptr;
+        const Column& column = columns[col];
+        return column.type.load(std::memory_order_relaxed) == ColumnType::String ? nullptr : &column;
+    }
+
+    std::vector<Column> columns;
+};
+
+struct QCsv::Locks {
+    static constexpr int SHARDS = 64;
+
+    // 读写单元格持有共享锁；加载、清空、扩展行列等改变表结构的操作持有独占锁
+    QReadWriteLock table;
+    // 按存储块分片，写单元格时独占所在分片
+    std::array<QReadWriteLock, SHARDS> shards;
+    // 搜索索引在读取时也可能被建立，单独保护
+    QMutex index;
+
+    static int shardOf(int row) { return (row >> CsvStorage::BLOCK_SHIFT) & (SHARDS - 1); }
+};
+
+namespace {
+
+// 依次获取全部分片的读锁：整表读取期间阻塞写入，但不阻塞单元格读取
+class ShardsReadLocker {
+public:
+    ShardsReadLocker(QReadWriteLock* shards, int count) : shards(shards), count(shards ? count : 0) {
+        for (int i = 0; i < this->count; ++i) shards[i].lockForRead();
+    }
+    ~ShardsReadLocker() {
+        for (int i = count - 1; i >= 0; --i) shards[i].unlock();
+    }
+    ShardsReadLocker(const ShardsReadLocker&) = delete;
+    ShardsReadLocker& operator=(const ShardsReadLocker&) = delete;
+
+private:
+    QReadWriteLock* shards;
+    int count;
+};
+
+// 单元格写锁：不改变表结构时只独占所在分片，需要扩展行列或块表时独占整表
+class CellWriteLocker {
+public:
+    template<typename Grows>
+    CellWriteLocker(QReadWriteLock* table, QReadWriteLock* shard, Grows&& grows) : table(table) {
+        if (!table) return;
+        table->lockForRead();
+        if (!grows()) {
+            this->shard = shard;
+            shard->lockForWrite();
+            return;
+        }
+        table->unlock();
+        table->lockForWrite();
+    }
+    ~CellWriteLocker() {
+        if (shard) shard->unlock();
+        if (table) table->unlock();
+    }
+    CellWriteLocker(const CellWriteLocker&) = delete;
+    CellWriteLocker& operator=(const CellWriteLocker&) = delete;
+
+private:
+    QReadWriteLock* table;
+    QReadWriteLock* shard = nullptr;
+};
+
+} // namespace
+
+// ==================== 运行指标 ====================
+
+struct QCsv::MetricsState {
+    struct Event {
+        const char* name;
+        qint64 begin;       // 相对 clock 的纳秒
+        qint64 duration;
+        qint64 thread;
+        QJsonObject args;
+    };
+
+    QMutex mutex;           // 查找时建立索引、后台保存可能在其他线程记录
+    Metrics metrics;
+    std::vector<Event> events;  // 环形缓冲区，满后覆盖最早的事件
+    size_t nextEvent = 0;       // 满时为最早事件的位置
+    QElapsedTimer clock;    // trace 的时间原点
+
+    MetricsState() { clock.start(); }
+
+    void set(qint64 Metrics::* field, qint64 value) {
+        QMutexLocker locker(&mutex);
+        metrics.*field = value;
+    }
+
+    void resetLoad() {
+        QMutexLocker locker(&mutex);
+        const Metrics previous = metrics;
+        metrics = Metrics{};
+        metrics.indexBuildNs = previous.indexBuildNs;
+        metrics.saveNs = previous.saveNs;
+        metrics.savePrepareNs = previous.savePrepareNs;
+        metrics.saveWriteNs = previous.saveWriteNs;
+        metrics.saveCommitNs = previous.saveCommitNs;
+        metrics.bytesWritten = previous.bytesWritten;
+    }
+
+    Metrics current() {
+        QMutexLocker locker(&mutex);
+        return metrics;
+    }
+
+    void resetSave() {
+        QMutexLocker locker(&mutex);
+        metrics.saveNs = metrics.savePrepareNs = metrics.saveWriteNs = metrics.saveCommitNs = 0;
+        metrics.bytesWritten = 0;
+    }
+};
+
+// 计时一个阶段：结束时把耗时写入 field（可为空）并记录一个 trace 事件；未开启指标时不读时钟
+class QCsv::Phase {
+public:
+    Phase(MetricsState* state, const char* name, qint64 Metrics::* field = nullptr)
+        : state(state), name(name), field(field) {
+        if (state) begin = state->clock.nsecsElapsed();
+    }
+    ~Phase() { finish(); }
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+
+    void finish() {
+        if (!state) return;
+        const qint64 duration = state->clock.nsecsElapsed() - begin;
+        QMutexLocker locker(&state->mutex);
+        if (field) state->metrics.*field = duration;
+        const qint64 thread = static_cast<qint64>(reinterpret_cast<quintptr>(QThread::currentThread()));
+        MetricsState::Event event{ name, begin, duration, thread, args };
+        if (state->events.size() < static_cast<size_t>(MAX_TRACE_EVENTS)) {
+            state->events.push_back(std::move(event));
+        } else {
+            state->events[state->nextEvent] = std::move(event);
+            state->nextEvent = (state->nextEvent + 1) % state->events.size();
+        }
+        state = nullptr;
+    }
+
+    QJsonObject args;       // 附加到 trace 事件
+
+private:
+    MetricsState* state;
+    const char* name;
+    qint64 Metrics::* field;
+    qint64 begin = 0;
+};
+
+void QCsv::setMetricsEnabled(bool enable) {
+    if (enable == metricsEnabled()) return;
+    metricsState = enable ? std::make_shared<MetricsState>() : nullptr;
+}
+
+QCsv::Metrics QCsv::metrics() const {
+    return metricsState ? metricsState->current() : Metrics{};
+}
+
+QByteArray QCsv::metricsTrace() const {
+    QJsonArray events;
+    if (metricsState) {
+        QMutexLocker locker(&metricsState->mutex);
+        // 从最早的事件开始
+        const std::vector<MetricsState::Event>& recorded = metricsState->events;
+        for (size_t i = 0; i < recorded.size(); ++i) {
+            const MetricsState::Event& event = recorded[(metricsState->nextEvent + i) % recorded.size()];
+            QJsonObject object;
+            object.insert("name", event.name);
+            object.insert("cat", "qtcsv");
+            object.insert("ph", "X");   // 完整事件：起点 + 时长，单位微秒
+            object.insert("ts", event.begin / 1000.0);
+            object.insert("dur", event.duration / 1000.0);
+            object.insert("pid", 1);
+            object.insert("tid", event.thread);
+            if (!event.args.isEmpty()) object.insert("args", event.args);
+            events.append(object);
+        }
+    }
+    QJsonObject trace;
+    trace.insert("traceEvents", events);
+    trace.insert("displayTimeUnit", "ms");
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+void QCsv::publishMetrics() {
+    if (metricsState) {
+        emit metricsReady(metrics());
+    }
+}
+
+QCsv::QCsv(const QString& filePath, QObject* parent)
+    : QObject(parent), filePath(filePath), searchIndex(std::make_unique<SearchIndex>()) {
+    streamOptions.indexStride = 64;
+    try {
+        open(filePath);
+    } catch (const std::exception& e) {
+        emit error(tr("Failed to open file: %1").arg(e.what()));
+    }
+}
+
+QCsv::~QCsv() {
+    for (QFuture<bool>& pending : pendingSyncs) {
+        pending.waitForFinished();
+    }
+    try {
+        closeStream();
+    } catch (const std::exception& e) {
+        qWarning() << "Error in QCsv destructor:" << e.what();
+    }
+}
+
+QCsv::QCsv(QCsv&& other) noexcept
+    : QObject(other.parent()),
+      filePath(std::move(other.filePath)),
+      storage(std::move(other.storage)),
+      separator(other.separator),
+      loadOptions(other.loadOptions),
+      projection(std::move(other.projection)),
+      rowSubset(other.rowSubset),
+      lazy(std::move(other.lazy)),
+      searchIndex(std::make_unique<SearchIndex>()),
+      sourceRows(std::move(other.sourceRows)),
+      typed(std::move(other.typed)),
+      metricsState(std::move(other.metricsState)),
+      locks(std::move(other.locks)),
+      opened(other.opened),
+      streamOptions(other.streamOptions),
+      streamReader(std::move(other.streamReader)),
+      streamCol(other.streamCol),
+      atEnd(other.atEnd) {
+    
+    // 完全重置原对象的状态
+    other.opened = false;
+    other.streamCol = 0;
+    other.atEnd = true;  // 设置为已结束
+    searchIndex.swap(other.searchIndex);
+}
+
+QCsv& QCsv::operator=(QCsv&& other) noexcept {
+    if (this != &other) {
+        setParent(other.parent());
+        filePath = std::move(other.filePath);
+        storage = std::move(other.storage);
+        searchIndex.swap(other.searchIndex);
+        other.searchIndex->reset();
+        separator = other.separator;
+        loadOptions = other.loadOptions;
+        projection = std::move(other.projection);
+        rowSubset = other.rowSubset;
+        lazy = std::move(other.lazy);
+        sourceRows = std::move(other.sourceRows);
+        typed = std::move(other.typed);
+        metricsState = std::move(other.metricsState);
+        locks = std::move(other.locks);
+        opened = other.opened;
+        streamOptions = other.streamOptions;
+        streamReader = std::move(other.streamReader);
+        streamCol = other.streamCol;
+        atEnd = other.atEnd;
+
+        other.filePath.clear();
+        other.opened = false;
+        other.streamCol = 0;
+        other.atEnd = true;
+    }
+    return *this;
+}
+
+void QCsv::open(const QString& filePath) {
+    if (filePath.isEmpty()) {
+        throw std::runtime_error("File path cannot be empty");
+    }
+    
+    this->filePath = filePath;
+    QFile file(filePath);
+    
+    if (!file.exists()) {
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            throw std::runtime_error("Could not create file: " + filePath.toStdString());
+        }
+        file.close();
+    }
+    
+    opened = true;
+    emit fileOpened(filePath);
+}
+
+void QCsv::close() {
+    if (!isOpen()) {
+        throw std::runtime_error("File is not open");
+    }
+    opened = false;
+    clear();
+    closeStream();
     emit fileClosed();
 }
 
@@ -517,32 +1259,693 @@ void QCsv::load() {
         throw std::runtime_error("Could not open file: " + filePath.toStdString());
     }
     
-    csvModel.clear();
-    searchModel.clear();
+    std::vector<int> columns = resolveProjection();
+    const LoadOptions& o = loadOptions;
+    if (o.startRow < 0 || o.tailRows < 0 || o.stride < 1 || o.sampleSize < 0) {
+        throw std::invalid_argument("Invalid row range");
+    }
+    const bool selectsRows = o.startRow > 0 || o.rowLimit >= 0 || o.tailRows > 0 || o.stride > 1 || o.sampleSize > 0;
+
+    QWriteLocker table(tableLock());
+    if (metricsState) metricsState->resetLoad();
+    Phase loading(metricsState.get(), "load", &Metrics::loadNs);
+    storage.clear();
+    storage.setUtf8Storage(o.utf8Storage);
+    searchIndex->reset();
+    lazy.reset();
+    sourceRows.reset();
+    typed.reset();
+    projection = std::move(columns);
+    rowSubset = selectsRows;
+    
+    const qint64 fileSize = file.size();
+    Utf8CsvParser::Statistics stats;
+    if (selectsRows) {
+        if (o.lazy || o.parallel) {
+            qWarning() << "lazy and parallel loading are ignored when loading a range of rows";
+        }
+        stats = loadRows(file);
+    } else if (loadOptions.lazy) {
+        stats = loadLazy(file);
+    } else if (loadOptions.parallel && file.size() >= loadOptions.parallelThreshold) {
+        stats = loadParallel(file);
+    } else if (loadOptions.memoryMap) {
+        stats = loadMapped(file);
+    } else {
+        stats = loadSerial(file);
+    }
+    file.close();
+    
+    // 更新最大行列
+    maxRow = std::max(1, stats.maxRow);
+    maxCol = std::max(1, stats.maxCol);
+
+    if (metricsState) {
+        QMutexLocker locker(&metricsState->mutex);
+        Metrics& m = metricsState->metrics;
+        m.bytesRead = stats.bytes;
+        m.tokenizeNs = stats.tokenizeNs;
+        m.insertNs = stats.insertNs;
+        m.rows = stats.maxRow;
+        m.cells = stats.totalCells;
+        m.emptyCells = stats.emptyCells;
+        m.quotedCells = stats.quotedCells;
+        loading.args.insert("file", filePath);
+        loading.args.insert("bytes", stats.bytes);
+    }
+    
+    if (loadOptions.trackChanges) {
+        if (projection.empty() && !selectsRows) {
+            indexSourceRows(fileSize);
+        } else {
+            qWarning() << "trackChanges is ignored when loading a subset of rows or columns";
+        }
+    }
+    
+    if (loadOptions.inferTypes) {
+        Phase phase(metricsState.get(), "inferTypes", &Metrics::typeInferenceNs);
+        inferColumnTypes();
+    }
+    
+    if (locks) {
+        // 并发模式下读取路径不能再修改存储（行缓存、整块解码），加载完即整体解码
+        Phase phase(metricsState.get(), "materialize");
+        materializeLazy();
+        storage.releaseMapping();
+    }
     
+    // 映射单元格（deferDecode）仍在时不预先建立索引：建立索引要解码全部单元格，延迟解码就失去了意义
+    if (loadOptions.buildSearchIndex && !lazy && !storage.hasMapping()) {
+        ensureSearchIndex();
+    }
+    if (metricsState) metricsState->set(&Metrics::allocations, storage.allocationCount());
+    table.unlock();
+    loading.finish();
+    publishMetrics();
+}
+
+// 把 LoadOptions::columns / columnNames 解析为列投影，未选择列时返回空
+std::vector<int> QCsv::resolveProjection() const {
+    std::vector<int> sources;
+    for (int col : loadOptions.columns) {
+        if (col < 1) {
+            throw std::invalid_argument("Column numbers are 1-based");
+        }
+        sources.push_back(col - 1);
+    }
+    if (!loadOptions.columnNames.isEmpty()) {
+        // 先只读出表头行
+        CsvReader reader(filePath, separator);
+        QStringList headers;
+        if (reader.seekToRow(headerRow - 1) && reader.nextRow()) {
+            headers = reader.row().toStringList();
+        }
+        for (const QString& name : loadOptions.columnNames) {
+            const qsizetype index = headers.indexOf(name);
+            if (index < 0) {
+                throw std::invalid_argument("Unknown column: " + name.toStdString());
+            }
+            sources.push_back(static_cast<int>(index));
+        }
+    }
+
+    std::vector<int> columns;
+    int target = 0;
+    for (int source : sources) {
+        if (static_cast<size_t>(source) >= columns.size()) columns.resize(source + 1, -1);
+        if (columns[source] < 0) columns[source] = target++;  // 重复的列只保留第一次
+    }
+    return columns;
+}
+
+Utf8CsvParser::Statistics QCsv::loadSerial(QFile& file) {
     const qint64 CHUNK_SIZE = 1024 * 1024; // 1MB
     QByteArray buffer;
     buffer.reserve(CHUNK_SIZE);
     
     // 使用新的 UTF-8 感知解析器
-    Utf8CsvParser parser(csvModel, searchModel, separator);
+    Utf8CsvParser parser(storage, separator);
+    if (!projection.empty()) parser.setProjection(&projection);
+    parser.setTiming(metricsState != nullptr);
     
+    Phase parsing(metricsState.get(), "parse");
+    QElapsedTimer timer;
+    qint64 ioWait = 0;
     while (!file.atEnd()) {
+        if (metricsState) timer.start();
         buffer = file.read(CHUNK_SIZE);
+        if (metricsState) ioWait += timer.nsecsElapsed();
         if (!buffer.isEmpty()) {
             parser.parse(buffer.constData(), buffer.size(), false);
         }
     }
     
     parser.finalize();
-    file.close();
-    
-    // 更新最大行列
-    auto stats = parser.getStatistics();
-    maxRow = std::max(1, stats.maxRow);
-    maxCol = std::max(1, stats.maxCol);
-    
-    qDebug() << "Loaded" << csvModel.size() << "cells from CSV";
+    if (metricsState) metricsState->set(&Metrics::ioWaitNs, ioWait);
+    return parser.getStatistics();
+}
+
+namespace {
+
+// 只读映射整个文件，映射随返回的指针一起释放；失败时返回空指针
+std::shared_ptr<const char> mapFile(const QString& path, qint64 size) {
+    if (size <= 0) return nullptr;
+
+    auto file = std::make_unique<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly)) return nullptr;
+    uchar* data = file->map(0, size);
+    if (!data) return nullptr;
+
+#ifdef Q_OS_UNIX
+    madvise(data, static_cast<size_t>(size), MADV_SEQUENTIAL);
+#endif
+
+    QFile* owner = file.release();
+    return std::shared_ptr<const char>(reinterpret_cast<const char*>(data),
+                                       [owner](const char*) { delete owner; });
+}
+
+} // namespace
+
+Utf8CsvParser::Statistics QCsv::loadMapped(QFile& file) {
+    const qint64 size = file.size();
+    Phase mapping(metricsState.get(), "map", &Metrics::ioWaitNs);
+    std::shared_ptr<const char> data = mapFile(filePath, size);
+    mapping.finish();
+    if (!data) {
+        return loadSerial(file);
+    }
+
+    Utf8CsvParser parser(storage, separator);
+    if (!projection.empty()) parser.setProjection(&projection);
+    parser.setTiming(metricsState != nullptr);
+    if (loadOptions.deferDecode) {
+        storage.setMapping(data);
+        parser.setZeroCopy(true);
+    }
+    Phase parsing(metricsState.get(), "parse");
+    parser.parse(data.get(), static_cast<size_t>(size), true);
+    return parser.getStatistics();
+}
+
+Utf8CsvParser::Statistics QCsv::loadLazy(QFile& file) {
+    auto rows = std::make_unique<LazyRows>();
+    rows->size = file.size();
+    Phase mapping(metricsState.get(), "map", &Metrics::ioWaitNs);
+    rows->source = mapFile(filePath, rows->size);
+    const bool mapped = rows->source != nullptr;
+    if (!mapped) {
+        auto content = std::make_shared<QByteArray>(file.readAll());
+        rows->source = std::shared_ptr<const char>(content, content->constData());
+    }
+    mapping.finish();
+
+    // 只扫描一遍建立行索引，单元格不解码
+    Utf8CsvParser parser(storage, separator);
+    if (!projection.empty()) parser.setProjection(&projection);
+    parser.setTiming(metricsState != nullptr);
+    parser.setRowIndex(&rows->offsets, rows->source.get());
+    Phase parsing(metricsState.get(), "indexRows");
+    parser.parse(rows->source.get(), static_cast<size_t>(rows->size), true);
+    parsing.finish();
+
+#ifdef Q_OS_UNIX
+    if (mapped) {
+        // 之后按行随机访问，关闭预读
+        madvise(const_cast<char*>(rows->source.get()), static_cast<size_t>(rows->size), MADV_RANDOM);
+    }
+#endif
+
+    rows->loaded.assign(rows->offsets.size(), false);
+    rows->cells = parser.getStatistics().totalCells;
+    rows->cache.setMaxCost(std::max(1, loadOptions.rowCacheSize));
+    lazy = std::move(rows);
+    return parser.getStatistics();
+}
+
+bool QCsv::isLazyRow(int row) const {
+    return lazy && row >= 0 && static_cast<size_t>(row) < lazy->offsets.size() && !lazy->loaded[row];
+}
+
+QStringList QCsv::parseLazyRow(int row) const {
+    const quint64 begin = lazy->offsets[row];
+    const quint64 end = static_cast<size_t>(row) + 1 < lazy->offsets.size()
+                        ? lazy->offsets[row + 1] : static_cast<quint64>(lazy->size);
+
+    CsvStorage rowStorage;
+    Utf8CsvParser parser(rowStorage, separator);
+    if (!projection.empty()) parser.setProjection(&projection);
+    parser.parse(lazy->source.get() + begin, end - begin, true);
+
+    QStringList fields;
+    const int columns = parser.getStatistics().maxCol;
+    fields.reserve(columns);
+    for (int col = 0; col < columns; ++col) {
+        fields.append(rowStorage.value(0, col));
+    }
+    return fields;
+}
+
+QStringList QCsv::lazyRow(int row) const {
+    if (const QStringList* cached = lazy->cache.object(row)) {
+        return *cached;
+    }
+    QStringList fields = parseLazyRow(row);
+    lazy->cache.insert(row, new QStringList(fields));
+    return fields;
+}
+
+void QCsv::loadLazyRow(int row) {
+    if (!isLazyRow(row)) return;
+
+    const QStringList fields = lazyRow(row);
+    for (int col = 0; col < fields.size(); ++col) {
+        storage.setValue(row, col, fields[col]);
+    }
+    lazy->loaded[row] = true;
+    lazy->cache.remove(row);
+}
+
+void QCsv::materializeLazy() {
+    if (!lazy) return;
+    std::unique_ptr<LazyRows> rows = std::move(lazy);
+
+    // 整体解析源数据，再用修改过的行覆盖
+    CsvStorage overlay = std::move(storage);
+    storage.clear();
+    Utf8CsvParser parser(storage, separator);
+    if (!projection.empty()) parser.setProjection(&projection);
+    parser.parse(rows->source.get(), static_cast<size_t>(rows->size), true);
+
+    for (size_t row = 0; row < rows->loaded.size(); ++row) {
+        if (!rows->loaded[row]) continue;
+        for (int col = 0; col < maxCol; ++col) {
+            storage.remove(static_cast<int>(row), col);
+        }
+    }
+    overlay.forEach([this](int row, int col, QStringView value) {
+        storage.setValue(row, col, value);
+    });
+    searchIndex->reset();
+}
+
+QString QCsv::cellValue(int row, int col) const {
+    if (!isLazyRow(row)) {
+        return storage.value(row, col);
+    }
+    const QStringList fields = lazyRow(row);
+    return col >= 0 && col < fields.size() ? fields[col] : QString();
+}
+
+template<typename Func>
+void QCsv::forEachCell(Func&& func) const {
+    if (!lazy) {
+        storage.forEach(func);
+        return;
+    }
+
+    // 懒加载模式逐行解析（不占用行缓存），修改过的行和新增行来自 storage
+    for (int row = 0; row < maxRow; ++row) {
+        if (isLazyRow(row)) {
+            const QStringList fields = parseLazyRow(row);
+            for (int col = 0; col < fields.size(); ++col) {
+                if (!fields[col].isEmpty()) func(row, col, QStringView(fields[col]));
+            }
+            continue;
+        }
+        for (int col = 0; col < maxCol; ++col) {
+            const QString value = storage.value(row, col);
+            if (!value.isEmpty()) func(row, col, QStringView(value));
+        }
+    }
+}
+
+// 按行遍历一列（0-based）的非空单元格，启用表头时跳过表头行
+template<typename Func>
+void QCsv::forEachInColumn(int col, Func&& func) const {
+    const int skipRow = headersOn ? headerRow - 1 : -1;
+    for (int row = 0; row < maxRow; ++row) {
+        if (row == skipRow) continue;
+        if (isLazyRow(row)) {
+            const QString value = cellValue(row, col);
+            if (!value.isEmpty()) func(row, QStringView(value));
+            continue;
+        }
+        if (storage.utf8Storage()) {
+            // 逐个解码，不把所在块整体转换为 UTF-16
+            const QString value = storage.value(row, col);
+            if (!value.isEmpty()) func(row, QStringView(value));
+            continue;
+        }
+        const QStringView value = storage.view(row, col);
+        if (!value.isEmpty()) func(row, value);
+    }
+}
+
+namespace {
+
+// 并行加载中的一个分块
+struct LoadChunk {
+    qint64 begin = 0;
+    qint64 end = 0;
+    qint64 quotes = 0;      // 原始切分内的引号数（奇偶预扫描）
+    qint64 rowEnds = 0;     // 块内引号外的行结束符数
+    int firstRow = 0;
+    CsvStorage storage;
+    Utf8CsvParser::Statistics stats;
+};
+
+// 从 pos 开始找到下一行的起始位置。inQuotes 为 pos 处是否位于引号内，
+// 由引号奇偶性决定：解析器中每个引号都会在"引号内/引号外"之间切换一次。
+qint64 nextRowStart(const char* data, qint64 pos, qint64 size, bool inQuotes) {
+    while (pos < size) {
+        if (inQuotes) {
+            pos = CsvSimd::findQuote(data + pos, data + size) - data;
+            if (pos >= size) break;
+            inQuotes = false;
+            ++pos;
+            continue;
+        }
+
+        const char ch = data[pos];
+        if (ch == '"') {
+            inQuotes = true;
+        } else if (ch == '\n') {
+            return pos + 1;
+        } else if (ch == '\r') {
+            return (pos + 1 < size && data[pos + 1] == '\n') ? pos + 2 : pos + 1;
+        }
+        ++pos;
+    }
+    return size;
+}
+
+// 统计 [begin, end) 内引号外的行结束符个数，begin 必须是行首；CRLF 计为一个
+qint64 countRowEnds(const char* begin, const char* end) {
+    const qint64 WINDOW_SIZE = 1024 * 1024;
+    std::vector<quint32> positions;
+    positions.reserve(64 * 1024);
+
+    qint64 rows = 0;
+    bool inQuotes = false;
+    const char* crNext = nullptr;
+    for (const char* window = begin; window < end; ) {
+        const char* windowEnd = window + std::min<qint64>(end - window, WINDOW_SIZE);
+        positions.clear();
+        CsvSimd::findStructural(window, windowEnd, '\n', positions);  // 只关心引号、CR、LF
+
+        for (quint32 offset : positions) {
+            const char* p = window + offset;
+            if (*p == '"') {
+                inQuotes = !inQuotes;
+            } else if (inQuotes) {
+                continue;
+            } else if (*p == '\r') {
+                ++rows;
+                crNext = p + 1;
+            } else if (p != crNext) {
+                ++rows;
+            }
+        }
+        window = windowEnd;
+    }
+    return rows;
+}
+
+} // namespace
+
+Utf8CsvParser::Statistics QCsv::loadParallel(QFile& file) {
+    const qint64 size = file.size();
+    const qint64 MIN_CHUNK_SIZE = 64 * 1024;
+
+    // 优先内存映射，失败时整体读入
+    Phase reading(metricsState.get(), "map", &Metrics::ioWaitNs);
+    QByteArray content;
+    std::shared_ptr<const char> mapping = mapFile(filePath, size);
+    const char* data = mapping.get();
+    if (!data) {
+        content = file.readAll();
+        data = content.constData();
+    }
+    reading.finish();
+    const bool zeroCopy = mapping && loadOptions.deferDecode;
+
+    const int threads = loadOptions.threadCount > 0 ? loadOptions.threadCount
+                                                    : std::max(1, QThread::idealThreadCount());
+    const qint64 chunkCount = std::max<qint64>(1, std::min<qint64>(threads * 4, size / MIN_CHUNK_SIZE));
+
+    std::vector<LoadChunk> chunks(chunkCount);
+    for (qint64 i = 0; i < chunkCount; ++i) {
+        chunks[i].begin = size * i / chunkCount;
+        chunks[i].end = size * (i + 1) / chunkCount;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    // 第一遍：并行统计每个原始切分的引号数，前缀奇偶性即为切分点是否位于引号内
+    Phase splitting(metricsState.get(), "split");
+    QtConcurrent::blockingMap(&pool, chunks, [data](LoadChunk& chunk) {
+        chunk.quotes = CsvSimd::countQuotes(data + chunk.begin, data + chunk.end);
+    });
+
+    // 将切分点后移到下一行的行首
+    qint64 quotesBefore = 0;
+    for (qint64 i = 0; i < chunkCount; ++i) {
+        const qint64 rawBegin = chunks[i].begin;
+        if (i > 0) {
+            chunks[i].begin = std::max(chunks[i - 1].begin,
+                                       nextRowStart(data, rawBegin, size, quotesBefore % 2 != 0));
+            chunks[i - 1].end = chunks[i].begin;
+        }
+        quotesBefore += chunks[i].quotes;
+    }
+    chunks.back().end = size;
+
+    // 第二遍：并行统计各块的行数，得到每块的全局起始行号
+    QtConcurrent::blockingMap(&pool, chunks, [data](LoadChunk& chunk) {
+        chunk.rowEnds = countRowEnds(data + chunk.begin, data + chunk.end);
+    });
+    qint64 row = 0;
+    for (LoadChunk& chunk : chunks) {
+        if (row > INT_MAX) {
+            throw std::runtime_error("CSV file has too many rows");
+        }
+        chunk.firstRow = static_cast<int>(row);
+        row += chunk.rowEnds;
+    }
+    splitting.finish();
+
+    // 第三遍：各块独立解析到自己的存储
+    const char sep = separator;
+    const std::vector<int>* columns = projection.empty() ? nullptr : &projection;
+    MetricsState* const state = metricsState.get();
+    const bool utf8 = storage.utf8Storage();
+    QtConcurrent::blockingMap(&pool, chunks, [data, sep, zeroCopy, utf8, columns, state, &mapping](LoadChunk& chunk) {
+        if (chunk.begin >= chunk.end) return;
+        Phase parsing(state, "parseChunk");
+        chunk.storage.setUtf8Storage(utf8);
+        Utf8CsvParser parser(chunk.storage, sep);
+        parser.setStartRow(chunk.firstRow);
+        parser.setProjection(columns);
+        parser.setTiming(state != nullptr);
+        if (zeroCopy) {
+            chunk.storage.setMapping(mapping);
+            parser.setZeroCopy(true);
+        }
+        parser.parse(data + chunk.begin, chunk.end - chunk.begin, true);
+        chunk.stats = parser.getStatistics();
+    });
+
+    // 按顺序合并
+    Phase merging(metricsState.get(), "merge");
+    Utf8CsvParser::Statistics stats;
+    for (LoadChunk& chunk : chunks) {
+        storage.merge(std::move(chunk.storage));
+        stats.maxRow = std::max(stats.maxRow, chunk.stats.maxRow);
+        stats.maxCol = std::max(stats.maxCol, chunk.stats.maxCol);
+        stats.totalCells += chunk.stats.totalCells;
+        stats.emptyCells += chunk.stats.emptyCells;
+        stats.quotedCells += chunk.stats.quotedCells;
+        stats.bytes += chunk.stats.bytes;
+        stats.tokenizeNs += chunk.stats.tokenizeNs;
+        stats.insertNs += chunk.stats.insertNs;
+    }
+
+    return stats;
+}
+
+// ==================== 行范围与抽样加载 ====================
+
+namespace {
+
+// 从行首 pos 开始逐行向后扫描，next() 返回下一行的起始偏移，到达末尾后一直返回 size
+class RowScanner {
+public:
+    RowScanner(const char* data, qint64 size, qint64 pos)
+        : data(data), size(size), windowBegin(pos), windowEnd(pos) {
+        positions.reserve(64 * 1024);
+    }
+
+    qint64 next() {
+        for (;;) {
+            while (index < positions.size()) {
+                const qint64 pos = windowBegin + positions[index++];
+                const char ch = data[pos];
+                if (ch == '"') {
+                    inQuotes = !inQuotes;
+                } else if (inQuotes || pos == crNext) {
+                    continue;
+                } else if (ch == '\r' && pos + 1 < size && data[pos + 1] == '\n') {
+                    crNext = pos + 1;   // CRLF 作为一个行结束符
+                    return pos + 2;
+                } else {
+                    return pos + 1;
+                }
+            }
+            if (windowEnd >= size) return size;
+
+            windowBegin = windowEnd;
+            windowEnd = windowBegin + std::min<qint64>(size - windowBegin, WINDOW_SIZE);
+            positions.clear();
+            index = 0;
+            CsvSimd::findStructural(data + windowBegin, data + windowEnd, '\n', positions);  // 只关心引号、CR、LF
+        }
+    }
+
+private:
+    static constexpr qint64 WINDOW_SIZE = 1024 * 1024;
+    const char* data;
+    qint64 size;
+    qint64 windowBegin;
+    qint64 windowEnd;
+    std::vector<quint32> positions;
+    size_t index = 0;
+    bool inQuotes = false;
+    qint64 crNext = -1;
+};
+
+// 从文件末尾向前找到倒数第 count 行的起始偏移，不早于行首 floor。
+// 文件末尾位于引号外，某位置之后的引号数为奇数即说明它在引号内，因此不必从头扫描就能恢复引号状态
+qint64 tailStart(const char* data, qint64 floor, qint64 size, qint64 count) {
+    const qint64 WINDOW_SIZE = 64 * 1024;
+    std::vector<quint32> positions;
+    bool inQuotes = false;
+    qint64 found = 0;
+    for (qint64 windowEnd = size; windowEnd > floor; ) {
+        const qint64 windowBegin = std::max(floor, windowEnd - WINDOW_SIZE);
+        positions.clear();
+        CsvSimd::findStructural(data + windowBegin, data + windowEnd, '\n', positions);
+
+        for (auto it = positions.rbegin(); it != positions.rend(); ++it) {
+            const qint64 pos = windowBegin + *it;
+            const char ch = data[pos];
+            if (ch == '"') {
+                inQuotes = !inQuotes;
+            } else if (inQuotes || (ch == '\r' && pos + 1 < size && data[pos + 1] == '\n')) {
+                continue;   // CRLF 在遇到其中的 LF 时已计入
+            } else if (pos + 1 < size && ++found == count) {
+                return pos + 1;
+            }
+        }
+        windowEnd = windowBegin;
+    }
+    return floor;
+}
+
+} // namespace
+
+Utf8CsvParser::Statistics QCsv::loadRows(QFile& file) {
+    const qint64 size = file.size();
+    Phase reading(metricsState.get(), "map", &Metrics::ioWaitNs);
+    QByteArray content;
+    std::shared_ptr<const char> mapping = mapFile(filePath, size);
+    const char* data = mapping.get();
+    if (!data) {
+        content = file.readAll();
+        data = content.constData();
+    }
+    reading.finish();
+
+    // 选中行的字节区间，按文件顺序排列，相邻的合并
+    std::vector<std::pair<qint64, qint64>> spans;
+    auto select = [&spans](qint64 begin, qint64 end) {
+        if (begin >= end) return;
+        if (!spans.empty() && spans.back().second == begin) {
+            spans.back().second = end;
+        } else {
+            spans.emplace_back(begin, end);
+        }
+    };
+
+    // 表头行原样保留
+    Phase scanning(metricsState.get(), "selectRows");
+    const LoadOptions& o = loadOptions;
+    RowScanner scanner(data, size, 0);
+    qint64 pos = 0;
+    for (int row = 0; headersOn && row < headerRow && pos < size; ++row) {
+        const qint64 end = scanner.next();
+        select(pos, end);
+        pos = end;
+    }
+
+    const qint64 limit = o.rowLimit < 0 ? std::numeric_limits<qint64>::max() : o.rowLimit;
+    auto candidate = [&o](qint64 row) {
+        return row >= o.startRow && (row - o.startRow) % o.stride == 0;
+    };
+    if (o.tailRows > 0) {
+        if (limit > 0) {
+            select(tailStart(data, pos, size, std::min(o.tailRows, limit)), size);
+        }
+    } else if (o.sampleSize > 0) {
+        // 蓄水池抽样仍需找出每个候选行的边界，但只解析抽中的行
+        const qint64 wanted = std::min(o.sampleSize, limit);
+        QRandomGenerator random(o.sampleSeed ? o.sampleSeed : QRandomGenerator::global()->generate());
+        std::vector<std::pair<qint64, qint64>> sample;
+        qint64 seen = 0;
+        for (qint64 row = 0; pos < size && wanted > 0; ++row) {
+            const qint64 end = scanner.next();
+            if (candidate(row)) {
+                if (seen < wanted) {
+                    sample.emplace_back(pos, end);
+                } else if (const qint64 slot = random.bounded(seen + 1); slot < wanted) {
+                    sample[slot] = { pos, end };
+                }
+                ++seen;
+            }
+            pos = end;
+        }
+        std::sort(sample.begin(), sample.end());
+        for (const auto& [begin, end] : sample) {
+            select(begin, end);
+        }
+    } else {
+        // 取够行数即停止扫描
+        for (qint64 row = 0, taken = 0; pos < size && taken < limit; ++row) {
+            const qint64 end = scanner.next();
+            if (candidate(row)) {
+                select(pos, end);
+                ++taken;
+            }
+            pos = end;
+        }
+    }
+
+    scanning.finish();
+
+    Utf8CsvParser parser(storage, separator);
+    if (!projection.empty()) parser.setProjection(&projection);
+    parser.setTiming(metricsState != nullptr);
+    Phase parsing(metricsState.get(), "parse");
+    if (mapping && o.memoryMap && o.deferDecode) {
+        storage.setMapping(mapping);
+        parser.setZeroCopy(true);
+    }
+    for (const auto& [begin, end] : spans) {
+        // 每段都以完整的行结束，逐段收尾，避免段尾的 CR 与下一段开头的 LF 被当作 CRLF
+        parser.parse(data + begin, static_cast<size_t>(end - begin), true);
+    }
+    return parser.getStatistics();
 }
 
 bool QCsv::save() {
@@ -550,6 +1953,9 @@ bool QCsv::save() {
         emit error("No file opened for saving");
         return false;
     }
+    if (canSaveIncrementally()) {
+        return saveIncremental();
+    }
     return saveAs(filePath);
 }
 
@@ -558,28 +1964,61 @@ bool QCsv::saveAs(const QString& newFilePath) {
         emit error("File path cannot be empty for saving");
         return false;
     }
+    if (refusesPartialSave(newFilePath)) {
+        return false;
+    }
+    
+    if (metricsState) metricsState->resetSave();
+    Phase saving(metricsState.get(), "save", &Metrics::saveNs);
+    Phase preparing(metricsState.get(), "prepare", &Metrics::savePrepareNs);
+
+    // 写入可能截断正被映射的源文件，先解码全部单元格（并发模式下加载时已解码）
+    if (!locks) {
+        storage.releaseMapping();
+        if (lazy && QFileInfo(newFilePath) == QFileInfo(filePath)) {
+            materializeLazy();
+        }
+    }
     
     QFile file(newFilePath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         emit error("Could not open file for writing: " + newFilePath);
         return false;
     }
+    preparing.finish();
     
-    QTextStream out(&file);
-
-    out.setEncoding(QStringConverter::Utf8);
+    Phase writing(metricsState.get(), "write", &Metrics::saveWriteNs);
+    bool success = writeTo(file);
+    const qint64 written = file.pos();
+    writing.finish();
 
-    bool success = writeToStream(out);
+    Phase committing(metricsState.get(), "commit", &Metrics::saveCommitNs);
     file.close();
+    committing.finish();
+    saving.finish();
     
     if (success) {
         emit fileSaved(newFilePath);
     }
+    if (metricsState) metricsState->set(&Metrics::bytesWritten, written);
+    publishMetrics();
     
     return success;
 }
 
+// 只加载了部分行或列时，写回源文件会丢掉未加载的数据，只允许另存为其它路径
+bool QCsv::refusesPartialSave(const QString& path) {
+    if ((!rowSubset && projection.empty()) || QFileInfo(path) != QFileInfo(filePath)) {
+        return false;
+    }
+    emit error("Cannot overwrite the source file after loading a subset of rows or columns: " + path);
+    return true;
+}
+
 bool QCsv::atomicSave() {
+    if (canSaveIncrementally()) {
+        return saveIncremental();
+    }
     return atomicSaveAs(filePath);
 }
 
@@ -588,151 +2027,758 @@ bool QCsv::atomicSaveAs(const QString& filePath) {
         emit error("File path cannot be empty for atomic save");
         return false;
     }
+    if (refusesPartialSave(filePath)) {
+        return false;
+    }
+    
+    if (metricsState) metricsState->resetSave();
+    Phase saving(metricsState.get(), "save", &Metrics::saveNs);
+    Phase preparing(metricsState.get(), "prepare", &Metrics::savePrepareNs);
+
+    // 部分平台上无法替换仍被映射的文件
+    if (!locks) {
+        storage.releaseMapping();
+        if (lazy && QFileInfo(filePath) == QFileInfo(this->filePath)) {
+            materializeLazy();
+        }
+    }
     
     QSaveFile saveFile(filePath);
     if (!saveFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
         emit error("Could not open file for atomic saving: " + filePath);
         return false;
     }
+    preparing.finish();
+
+    Phase writing(metricsState.get(), "write", &Metrics::saveWriteNs);
+    bool success = writeTo(saveFile);
+    const qint64 written = saveFile.pos();
+    writing.finish();
+    
+    Phase committing(metricsState.get(), "commit", &Metrics::saveCommitNs);
+    success = success && saveFile.commit();
+    committing.finish();
+    saving.finish();
+    if (metricsState) metricsState->set(&Metrics::bytesWritten, written);
+    publishMetrics();
+
+    if (success) {
+        emit fileSaved(filePath);
+        return true;
+    }
+    
+    saveFile.cancelWriting();
+    emit error("Could not commit atomic save for: " + filePath);
+    return false;
+}
+
+void QCsv::indexSourceRows(qint64 size) {
+    auto rows = std::make_unique<SourceRows>();
+    rows->size = size;
+    rows->modified = QFileInfo(filePath).lastModified();
+    rows->separator = separator;
+
+    if (lazy) {
+        rows->offsets = lazy->offsets;
+    } else if (size > 0) {
+        // 再扫描一遍只记录行起点，不解码单元格
+        std::shared_ptr<const char> data = mapFile(filePath, size);
+        if (!data) return;  // 无法映射时不支持增量保存
+        CsvStorage scratch;
+        Utf8CsvParser parser(scratch, separator);
+        parser.setRowIndex(&rows->offsets, data.get());
+        parser.parse(data.get(), static_cast<size_t>(size), true);
+    }
+    rows->dirty.assign(rows->offsets.size(), 0);
+    sourceRows = std::move(rows);
+}
+
+bool QCsv::canSaveIncrementally() const {
+    if (!sourceRows || sourceRows->separator != separator) return false;
+
+    // 文件在加载后被外部修改过时行偏移已失效
+    const QFileInfo info(filePath);
+    return info.exists() && info.size() == sourceRows->size && info.lastModified() == sourceRows->modified;
+}
+
+bool QCsv::saveIncremental() {
+    if (metricsState) metricsState->resetSave();
+    Phase overall(metricsState.get(), "save", &Metrics::saveNs);
+    Phase preparing(metricsState.get(), "prepare", &Metrics::savePrepareNs);
+    overall.args.insert("incremental", true);
+
+#ifdef Q_OS_WIN
+    // Windows 上无法替换仍被映射的文件
+    storage.releaseMapping();
+    materializeLazy();
+#endif
+
+    // 保存期间阻塞写入，不阻塞读取
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    if (!sourceRows) {
+        emit error("Change tracking was reset before saving: " + filePath);
+        return false;
+    }
+    SourceRows& rows = *sourceRows;
+    QMutexLocker saving(&rows.saving);
+
+    std::shared_ptr<const char> source = mapFile(filePath, rows.size);
+    if (rows.size > 0 && !source) {
+        emit error("Could not map file for incremental saving: " + filePath);
+        return false;
+    }
+
+    // 不加 Text 标志：未修改的行按原字节复制，换行符保持不变
+    QSaveFile saveFile(filePath);
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        emit error("Could not open file for atomic saving: " + filePath);
+        return false;
+    }
+
+    preparing.finish();
+
+    Phase writing(metricsState.get(), "write", &Metrics::saveWriteNs);
+    CsvWriter writer(saveFile, separator);
+    auto writeField = [&writer](QStringView value, const char* utf8, qsizetype size) {
+        if (utf8) writer.writeUtf8Field(utf8, size);
+        else writer.writeField(value);
+    };
+    auto writeRow = [&](int row, QByteArrayView lineEnd) {
+        for (int col = 0; col < maxCol; ++col) {
+            if (col > 0) writer.writeSeparator();
+            storage.visit(row, col, writeField);
+        }
+        writer.writeRaw(lineEnd.data(), lineEnd.size());
+    };
+
+    const size_t sourceCount = rows.offsets.size();
+    const size_t rowCount = std::max(sourceCount, static_cast<size_t>(maxRow));
+
+    // 改写的行沿用源文件中该行的行尾（CRLF、LF 或 CR），没有行尾的行和新增的行沿用第一行的行尾
+    auto sourceLineEnd = [&](size_t row) -> QByteArrayView {
+        const qint64 begin = static_cast<qint64>(rows.offsets[row]);
+        const qint64 end = row + 1 < sourceCount ? static_cast<qint64>(rows.offsets[row + 1]) : rows.size;
+        if (end > begin && source.get()[end - 1] == '\n') {
+            return end - 2 >= begin && source.get()[end - 2] == '\r' ? QByteArrayView("\r\n") : QByteArrayView("\n");
+        }
+        if (end > begin && source.get()[end - 1] == '\r') return QByteArrayView("\r");
+        return QByteArrayView();
+    };
+    QByteArrayView lineEnd = sourceCount > 0 ? sourceLineEnd(0) : QByteArrayView();
+    if (lineEnd.isEmpty()) lineEnd = QByteArrayView("\n");
+    std::vector<quint64> offsets;
+    offsets.reserve(rowCount);
+
+    // 连续未修改的行合并为一段，整段原样复制
+    qint64 pending = -1;
+    qint64 shift = 0;
+    auto copyPending = [&](qint64 end) {
+        if (pending < 0) return;
+        writer.writeRaw(source.get() + pending, end - pending);
+        pending = -1;
+    };
+
+    bool endsVerbatim = false;
+    for (size_t row = 0; row < sourceCount; ++row) {
+        const qint64 begin = static_cast<qint64>(rows.offsets[row]);
+        // 文件以行尾结束时最后一个偏移指向文件末尾，其后还有行时要写成空行
+        const bool emptyTail = begin == rows.size && row + 1 < rowCount;
+        endsVerbatim = !rows.dirty[row] && !emptyTail;
+        if (endsVerbatim) {
+            if (pending < 0) {
+                pending = begin;
+                shift = writer.bytesWritten() - begin;
+            }
+            offsets.push_back(static_cast<quint64>(begin + shift));
+            continue;
+        }
+        const bool loneCR = pending >= 0 && source.get()[begin - 1] == '\r';
+        copyPending(begin);
+        if (loneCR) {
+            writer.endRow();  // 单独的 CR 行尾后接 LF 会被合并成一个行尾，先补成 CRLF
+        }
+        offsets.push_back(static_cast<quint64>(writer.bytesWritten()));
+        // 源文件最后一行没有行尾时改写后也不加，除非后面还有新增的行
+        QByteArrayView end = sourceLineEnd(row);
+        if (end.isEmpty() && (begin == rows.size || row + 1 < rowCount)) end = lineEnd;
+        writeRow(static_cast<int>(row), end);
+    }
+    copyPending(rows.size);
+
+    if (sourceCount < rowCount) {
+        // 源文件不以行尾结束时先补上，再写新增的行；以单独的 CR 结束时补成 CRLF，
+        // 避免新增的空行的 LF 与之合并
+        if (endsVerbatim && rows.size > 0 && source.get()[rows.size - 1] != '\n') {
+            if (source.get()[rows.size - 1] == '\r') writer.endRow();
+            else writer.writeRaw(lineEnd.data(), lineEnd.size());
+        }
+        for (size_t row = sourceCount; row < rowCount; ++row) {
+            offsets.push_back(static_cast<quint64>(writer.bytesWritten()));
+            writeRow(static_cast<int>(row), lineEnd);
+        }
+    }
+
+    const qint64 written = writer.bytesWritten();
+    bool success = writer.flush();
+    source.reset();
+    writing.finish();
+
+    Phase committing(metricsState.get(), "commit", &Metrics::saveCommitNs);
+    success = success && saveFile.commit();
+    committing.finish();
+    overall.finish();
+    if (metricsState) metricsState->set(&Metrics::bytesWritten, written);
+    publishMetrics();
+    if (!success) {
+        saveFile.cancelWriting();
+        emit error("Could not commit atomic save for: " + filePath);
+        return false;
+    }
+
+    // 行偏移改为指向新文件
+    rows.offsets.swap(offsets);
+    rows.dirty.assign(rows.offsets.size(), 0);
+    rows.size = written;
+    rows.modified = QFileInfo(filePath).lastModified();
+    emit fileSaved(filePath);
+    return true;
+}
+
+namespace {
+
+// 按行优先顺序写出单元格，中间的空单元格只补分隔符和换行。forEach 可给出 UTF-8 单元格的原始字节
+// （同 CsvStorage::forEachRaw），这些字节直接写出，不经解码再编码
+template<typename ForEach>
+bool writeCells(QIODevice& device, char separator, int rows, int cols, ForEach&& forEach) {
+    CsvWriter writer(device, separator);
+    int curRow = 0;
+    int curCol = 0;
+    auto advance = [&](int row, int col) {
+        while (curRow < row) {
+            for (; curCol < cols - 1; ++curCol) writer.writeSeparator();
+            writer.endRow();
+            ++curRow;
+            curCol = 0;
+        }
+        for (; curCol < col; ++curCol) writer.writeSeparator();
+    };
+
+    forEach([&](int row, int col, QStringView value, const char* utf8 = nullptr, qsizetype size = 0) {
+        if (row >= rows || col >= cols) return;
+        advance(row, col);
+        if (utf8) writer.writeUtf8Field(utf8, size);
+        else writer.writeField(value);
+    });
+    advance(rows, 0);
+    return writer.flush();
+}
+
+} // namespace
+
+bool QCsv::writeTo(QIODevice& device) const {
+    try {
+        if (locks) {
+            // 并发模式：只在拍快照时阻塞写入，写文件期间不再持有锁
+            return captureSnapshot().writeTo(device);
+        }
+        return writeCells(device, separator, maxRow, maxCol, [this](auto&& func) {
+            if (lazy) forEachCell(func);
+            else storage.forEachRaw(func);
+        });
+    } catch (const std::exception& e) {
+        qWarning() << "Error writing to device:" << e.what();
+        return false;
+    }
+}
+
+void QCsv::clear() {
+    QWriteLocker table(tableLock());
+    storage.clear();
+    searchIndex->reset();
+    lazy.reset();
+    sourceRows.reset();
+    typed.reset();
+    projection.clear();
+    rowSubset = false;
+    maxRow = 1;
+    maxCol = 1;
+}
+
+QCsv::Snapshot QCsv::snapshot() {
+    if (!locks) {
+        // 共享的块在读取时不能再解码（并发模式下加载时已解码）
+        materializeLazy();
+        storage.releaseMapping();
+    }
+    return captureSnapshot();
+}
+
+QCsv::Snapshot QCsv::captureSnapshot() const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    Snapshot data;
+    data.storage = storage;  // 只复制块指针
+    data.rows = maxRow;
+    data.cols = maxCol;
+    data.separator = separator;
+    return data;
+}
+
+bool QCsv::saveSnapshot(const Snapshot& data, const QString& path, MetricsState* metrics) {
+    // 在后台线程运行：只使用传入的指标状态，不读取可能被同时修改的 metricsState
+    Phase saving(metrics, "save", &Metrics::saveNs);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        emit error("Could not open file for writing: " + path);
+        return false;
+    }
+
+    Phase writing(metrics, "write", &Metrics::saveWriteNs);
+    bool success = data.writeTo(file);
+    const qint64 written = file.pos();
+    writing.finish();
+
+    Phase committing(metrics, "commit", &Metrics::saveCommitNs);
+    file.close();
+    committing.finish();
+    saving.finish();
+
+    if (success) {
+        emit fileSaved(path);
+    }
+    if (metrics) {
+        metrics->set(&Metrics::bytesWritten, written);
+        emit metricsReady(metrics->current());
+    }
+    return success;
+}
+
+QFuture<bool> QCsv::sync() {
+    std::shared_ptr<const Snapshot> data;
+    if (isOpen() && refusesPartialSave(filePath)) {
+        return QtConcurrent::run([] { return false; });
+    }
+    if (metricsState) metricsState->resetSave();
+    if (isOpen()) {
+        Phase preparing(metricsState.get(), "prepare", &Metrics::savePrepareNs);
+        data = std::make_shared<const Snapshot>(snapshot());
+    }
+    const QString path = filePath;
+    const std::shared_ptr<MetricsState> metrics = metricsState;
+    pendingSyncs.removeIf([](const QFuture<bool>& pending) { return pending.isFinished(); });
+    QFuture<bool> future = QtConcurrent::run([this, data, path, metrics]() {
+        if (!data) {
+            emit error("No file opened for saving");
+            return false;
+        }
+        return saveSnapshot(*data, path, metrics.get());
+    });
+    pendingSyncs.append(future);
+    return future;
+}
+
+QString QCsv::Snapshot::getValue(const QString& key) const {
+    int row, col;
+    if (!CsvUtils::parseKey(key, row, col)) return QString();
+    return storage.value(row, col);
+}
+
+QString QCsv::Snapshot::getValue(int row, int col) const {
+    return storage.value(row - 1, col - 1);
+}
+
+bool QCsv::Snapshot::writeTo(QIODevice& device) const {
+    try {
+        return writeCells(device, separator, rows, cols, [this](auto&& func) {
+            storage.forEachRaw(func);
+        });
+    } catch (const std::exception& e) {
+        qWarning() << "Error writing snapshot:" << e.what();
+        return false;
+    }
+}
+
+void QCsv::finalize() {
+    if (save()) {
+        close();
+    }
+}
+
+QString QCsv::getValue(const QString& key) const {
+    int row, col;
+    if (!CsvUtils::parseKey(key, row, col)) return QString();
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row));
+    return cellValue(row, col);
+}
+
+std::optional<QString> QCsv::tryGetValue(const QString& key) const {
+    int row, col;
+    if (!CsvUtils::parseKey(key, row, col)) return std::nullopt;
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row));
+    QString value = cellValue(row, col);
+    if (value.isEmpty()) return std::nullopt;
+    return value;
+}
+
+QString QCsv::getValue(int row, int col) const {
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row - 1));
+    return cellValue(row - 1, col - 1);
+}
+
+std::optional<QAnyStringView> QCsv::getValueView(int row, int col) const {
+    if (locks) return std::nullopt;
+    if (isLazyRow(row - 1)) return std::nullopt;
+    return storage.storedView(row - 1, col - 1);
+}
+
+QByteArray QCsv::getValueUtf8(int row, int col) const {
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row - 1));
+    if (isLazyRow(row - 1)) return cellValue(row - 1, col - 1).toUtf8();
+    return storage.visit(row - 1, col - 1, [](QStringView value, const char* utf8, qsizetype size) {
+        return utf8 ? QByteArray(utf8, size) : value.toUtf8();
+    });
+}
+
+void QCsv::setValue(const QString& key, const QString& value) {
+    int row, col;
+    if (!CsvUtils::parseKey(key, row, col)) {
+        throw std::invalid_argument("Invalid cell key: " + key.toStdString());
+    }
+    setCell(row, col, value);
+}
+
+void QCsv::setValue(int row, int col, const QString& value) {
+    if (row < 1 || col < 1) throw std::invalid_argument("Row and column numbers must be >= 1");
+    setCell(row - 1, col - 1, value);
+}
+
+void QCsv::setCell(int row, int col, const QString& value) {
+    QString oldValue;
+    {
+        CellWriteLocker lock(tableLock(), shardLock(row), [&] {
+            return !value.isEmpty() && (row >= maxRow || col >= maxCol || row >= storage.rowCapacity());
+        });
+
+        oldValue = cellValue(row, col);
+        if (oldValue == value) {
+            return;  // 值未变化，无需更新也不发射 dataChanged
+        }
+
+        const quint64 cell = CsvUtils::packCell(row, col);
+        if (lazy) {
+            // 懒加载模式下不维护搜索索引，被修改的行整行转入 storage
+            loadLazyRow(row);
+            lazy->cells += (value.isEmpty() ? 0 : 1) - (oldValue.isEmpty() ? 0 : 1);
+        } else if (!oldValue.isEmpty()) {
+            QMutexLocker index(indexLock());
+            indexRemove(oldValue, cell);
+        }
+
+        storage.setValue(row, col, value);
+        if (sourceRows && static_cast<size_t>(row) < sourceRows->dirty.size()) {
+            sourceRows->dirty[row] = 1;
+        }
+        if (!value.isEmpty()) {
+            if (!lazy) {
+                QMutexLocker index(indexLock());
+                indexInsert(value, cell);
+            }
+            updateMaxRowCol(row, col);
+        }
+        if (typed) {
+            updateTyped(row, col, value);
+        }
+    }
+
+    // 只有在有接收者时才构造键
+    static const QMetaMethod changedSignal = QMetaMethod::fromSignal(&QCsv::dataChanged);
+    if (isSignalConnected(changedSignal)) {
+        emit dataChanged(CsvUtils::cellKey(row, col), oldValue, value);
+    }
+}
+
+void QCsv::setValues(const QHash<QString, QString>& values) {
+    for (auto it = values.begin(); it != values.end(); ++it) {
+        setValue(it.key(), it.value());
+    }
+}
+
+QHash<QString, QString> QCsv::getAllValues() const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QHash<QString, QString> values;
+    values.reserve(storage.size());
+    forEachCell([&values](int row, int col, QStringView value) {
+        values.insert(CsvUtils::cellKey(row, col), value.toString());
+    });
+    return values;
+}
+
+bool QCsv::contains(const QString& key) const {
+    int row, col;
+    if (!CsvUtils::parseKey(key, row, col)) return false;
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row));
+    return isLazyRow(row) ? !cellValue(row, col).isEmpty() : storage.contains(row, col);
+}
+
+QList<QString> QCsv::keys() const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QList<QString> result;
+    result.reserve(lazy ? lazy->cells : storage.size());
+    forEachCell([&result](int row, int col, QStringView) {
+        result.append(CsvUtils::cellKey(row, col));
+    });
+    return result;
+}
+
+void QCsv::ensureSearchIndex() const {
+    SearchIndex& index = *searchIndex;
+    if (index.kind != loadOptions.searchIndexKind) {
+        index.reset();
+        index.kind = loadOptions.searchIndexKind;
+    }
+
+    switch (index.kind) {
+    case SearchIndexKind::Ordered:
+        if (!index.built) {
+            Phase phase(metricsState.get(), "buildIndex", &Metrics::indexBuildNs);
+            storage.forEach([&index](int row, int col, QStringView value) {
+                index.ordered.insert(value.toString(), CsvUtils::packCell(row, col));
+            });
+            index.built = true;
+        }
+        break;
+    case SearchIndexKind::Hash:
+        if (!index.built) {
+            Phase phase(metricsState.get(), "buildIndex", &Metrics::indexBuildNs);
+            index.hash.reserve(storage.size());
+            storage.forEach([&index](int row, int col, QStringView value) {
+                index.hash.insert(value.toString(), CsvUtils::packCell(row, col));
+            });
+            index.built = true;
+        }
+        break;
+    case SearchIndexKind::Sorted:
+        ensureSortedIndex();
+        break;
+    }
+}
+
+void QCsv::ensureSortedIndex() const {
+    SearchIndex& index = *searchIndex;
+    if (index.sortedValid) return;
+    Phase phase(metricsState.get(), "buildIndex", &Metrics::indexBuildNs);
+
+    // 数组只保存单元格，比较时直接读取存储中的值
+    index.sorted.clear();
+    index.sorted.reserve(storage.size());
+    storage.forEach([&index](int row, int col, QStringView) {
+        index.sorted.push_back(CsvUtils::packCell(row, col));
+    });
+    std::sort(index.sorted.begin(), index.sorted.end(), [this](quint64 a, quint64 b) {
+        const int order = QAnyStringView::compare(sortKey(a), sortKey(b));
+        return order != 0 ? order < 0 : a < b;
+    });
+    index.sortedValid = true;
+}
+
+QAnyStringView QCsv::sortKey(quint64 cell) const {
+    const int row = CsvUtils::cellRow(cell);
+    const int col = CsvUtils::cellColumn(cell);
+    return storage.utf8Storage() ? storage.storedView(row, col) : QAnyStringView(storage.view(row, col));
+}
+
+QList<quint64> QCsv::findCells(const QString& value) const {
+    QList<quint64> cells;
+    if (lazy) {
+        // 懒加载模式没有搜索索引，顺序扫描
+        forEachCell([&](int row, int col, QStringView cell) {
+            if (cell == value) cells.append(CsvUtils::packCell(row, col));
+        });
+        return cells;
+    }
 
-    QTextStream out(&saveFile);
+    ensureSearchIndex();
+    const SearchIndex& index = *searchIndex;
+    switch (index.kind) {
+    case SearchIndexKind::Ordered: {
+        auto [begin, end] = index.ordered.equal_range(value);
+        for (auto it = begin; it != end; ++it) {
+            cells.append(it.value());
+        }
+        break;
+    }
+    case SearchIndexKind::Hash: {
+        auto [begin, end] = index.hash.equal_range(value);
+        for (auto it = begin; it != end; ++it) {
+            cells.append(it.value());
+        }
+        break;
+    }
+    case SearchIndexKind::Sorted: {
+        auto it = std::lower_bound(index.sorted.begin(), index.sorted.end(), value,
+            [this](quint64 cell, const QString& target) {
+                return QAnyStringView::compare(sortKey(cell), target) < 0;
+            });
+        for (; it != index.sorted.end() && QAnyStringView::equal(sortKey(*it), value); ++it) {
+            cells.append(*it);
+        }
+        break;
+    }
+    }
+    return cells;
+}
 
-    out.setEncoding(QStringConverter::Utf8);
+void QCsv::indexInsert(const QString& value, quint64 cell) {
+    SearchIndex& index = *searchIndex;
+    index.sortedValid = false;
+    if (!index.built) return;
 
-    bool success = writeToStream(out);
-    
-    if (success && saveFile.commit()) {
-        emit fileSaved(filePath);
-        return true;
+    if (index.kind == SearchIndexKind::Ordered) {
+        index.ordered.insert(value, cell);
+    } else if (index.kind == SearchIndexKind::Hash) {
+        index.hash.insert(value, cell);
     }
-    
-    saveFile.cancelWriting();
-    emit error("Could not commit atomic save for: " + filePath);
-    return false;
 }
 
-bool QCsv::writeToStream(QTextStream& out) const {
-    try {
-        for (int row = 1; row <= maxRow; ++row) {
-            for (int col = 1; col <= maxCol; ++col) {
-                QString colStr = CsvUtils::numberToColumnRow(col - 1);
-                QString key = colStr % QString::number(row);
-                QString value = csvModel.value(key);
-                
-                if (CsvUtils::needsQuotes(value, separator)) {
-                    out << '"' << CsvUtils::escapeQuotes(value) << '"';
-                } else {
-                    out << value;
-                }
+void QCsv::indexRemove(const QString& value, quint64 cell) {
+    SearchIndex& index = *searchIndex;
+    index.sortedValid = false;
+    if (!index.built) return;
 
-                if (col < maxCol) {
-                    out << separator;
-                }
+    if (index.kind == SearchIndexKind::Ordered) {
+        auto [begin, end] = index.ordered.equal_range(value);
+        for (auto it = begin; it != end; ++it) {
+            if (it.value() == cell) {
+                index.ordered.erase(it);
+                break;
             }
-            out << '\n';
         }
-        return true;
-    } catch (const std::exception& e) {
-        qWarning() << "Error writing to stream:" << e.what();
-        return false;
+    } else if (index.kind == SearchIndexKind::Hash) {
+        index.hash.remove(value, cell);
     }
 }
 
-void QCsv::clear() {
-    csvModel.clear();
-    searchModel.clear();
-    maxRow = 1;
-    maxCol = 1;
+void QCsv::updateMaxRowCol(int row, int col) {
+    // 并发模式下只有持有整表独占锁时才会真正修改
+    if (row >= maxRow) {
+        maxRow = row + 1;
+        if (typed) {
+            // 类型化列与表格同高，之后的写入只改动已有元素
+            for (TypedColumns::Column& column : typed->columns) {
+                if (column.inferred != ColumnType::String) column.resize(static_cast<size_t>(maxRow));
+            }
+        }
+    }
+    if (col >= maxCol) maxCol = col + 1;
 }
 
-QFuture<bool> QCsv::sync() {
-    return QtConcurrent::run([this]() {
-        return save();
-    });
+int QCsv::getRowCount() const {
+    QReadLocker table(tableLock());
+    return maxRow;
 }
 
-void QCsv::finalize() {
-    if (save()) {
-        close();
-    }
+int QCsv::getColumnCount() const {
+    QReadLocker table(tableLock());
+    return maxCol;
 }
 
-QString QCsv::getValue(const QString& key) const {
-    return csvModel.value(key);
+void QCsv::setConcurrent(bool enable) {
+    if (enable == (locks != nullptr)) return;
+    if (!enable) {
+        locks.reset();
+        return;
+    }
+
+    // 懒加载的行缓存和映射块的解码都发生在读取路径上，先整体解码
+    materializeLazy();
+    storage.releaseMapping();
+    locks = std::make_unique<Locks>();
 }
 
-std::optional<QString> QCsv::tryGetValue(const QString& key) const {
-    auto it = csvModel.find(key);
-    if (it != csvModel.end()) {
-        return *it;
-    }
-    return std::nullopt;
+QReadWriteLock* QCsv::tableLock() const {
+    return locks ? &locks->table : nullptr;
 }
 
-void QCsv::setValue(const QString& key, const QString& value) {
-    QString oldValue = csvModel.value(key);
-    
-    if (value.isEmpty()) {
-        if (!oldValue.isEmpty()) {
-            csvModel.remove(key);
-            removeFromSearch(oldValue, key);
-        }
-    } else {
-        if (!oldValue.isEmpty()) {
-            if (oldValue != value) {            // ✅ 避免值相同时重复操作
-                removeFromSearch(oldValue, key);
-            } else {
-                // 值相同且非空，无需任何操作，可直接返回（或保留现有逻辑但跳过更新）
-                // 注意：如果此处直接返回，需确保 dataChanged 不会被发射
-                return;  // 或者跳过后续插入，因为 csvModel 中已有相同键值对
-            }
-        }
-        csvModel.insert(key, value);
-        searchModel.insert(value, key);
-        updateMaxRowCol(key);
-    }
-    
-    if (oldValue != value) {
-        emit dataChanged(key, oldValue, value);
-    }
+QReadWriteLock* QCsv::shardLock(int row) const {
+    return locks ? &locks->shards[Locks::shardOf(row)] : nullptr;
 }
 
-void QCsv::setValues(const QHash<QString, QString>& values) {
-    for (auto it = values.begin(); it != values.end(); ++it) {
-        setValue(it.key(), it.value());
-    }
+QReadWriteLock* QCsv::shardLocks() const {
+    return locks ? locks->shards.data() : nullptr;
 }
 
-void QCsv::removeFromSearch(const QString& value, const QString& key) {
-    auto [begin, end] = searchModel.equal_range(value);
-    for (auto it = begin; it != end; ) {
-        if (it.value() == key) {
-            it = searchModel.erase(it);
-            break;
-        } else {
-            ++it;
-        }
-    }
+QMutex* QCsv::indexLock() const {
+    return locks ? &locks->index : nullptr;
 }
 
-void QCsv::updateMaxRowCol(const QString& key) {
-    auto [colPart, rowPart] = CsvUtils::splitKey(key);
-    maxRow = std::max(maxRow, rowPart + 1);
-    maxCol = std::max(maxCol, CsvUtils::columnRowToNumber(colPart) + 1);
+int QCsv::size() const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    return static_cast<int>(lazy ? lazy->cells : storage.size());
 }
 
 QList<QString> QCsv::search(const QString& value) const {
-    return searchModel.values(value);
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QMutexLocker index(indexLock());
+    QList<QString> results;
+    for (quint64 cell : findCells(value)) {
+        results.append(CsvUtils::cellKey(CsvUtils::cellRow(cell), CsvUtils::cellColumn(cell)));
+    }
+    return results;
 }
 
 QList<QString> QCsv::searchByPrefix(const QString& prefix) const {
     QList<QString> results;
     if (prefix.isEmpty()) return results;
+
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QMutexLocker indexGuard(indexLock());
     
-    auto it = searchModel.lowerBound(prefix);
-    while (it != searchModel.end() && it.key().startsWith(prefix)) {
-        results.append(it.value());
-        ++it;
+    if (lazy) {
+        forEachCell([&](int row, int col, QStringView cell) {
+            if (cell.startsWith(prefix)) results.append(CsvUtils::cellKey(row, col));
+        });
+        return results;
+    }
+    
+    ensureSearchIndex();
+    const SearchIndex& index = *searchIndex;
+    if (index.kind == SearchIndexKind::Ordered) {
+        auto it = index.ordered.lowerBound(prefix);
+        while (it != index.ordered.end() && it.key().startsWith(prefix)) {
+            results.append(CsvUtils::cellKey(CsvUtils::cellRow(it.value()), CsvUtils::cellColumn(it.value())));
+            ++it;
+        }
+        return results;
+    }
+    
+    // 哈希索引不支持前缀查询，改用排序数组
+    ensureSortedIndex();
+    auto it = std::lower_bound(index.sorted.begin(), index.sorted.end(), prefix,
+        [this](quint64 cell, const QString& target) {
+            return QAnyStringView::compare(sortKey(cell), target) < 0;
+        });
+    const QByteArray prefixUtf8 = prefix.toUtf8();
+    auto hasPrefix = [&](QStringView value, const char* utf8, qsizetype size) {
+        return utf8 ? QByteArrayView(utf8, size).startsWith(prefixUtf8) : value.startsWith(prefix);
+    };
+    for (; it != index.sorted.end(); ++it) {
+        const int row = CsvUtils::cellRow(*it);
+        const int col = CsvUtils::cellColumn(*it);
+        const bool matches = storage.utf8Storage() ? storage.visit(row, col, hasPrefix)
+                                                   : storage.view(row, col).startsWith(prefix);
+        if (!matches) break;
+        results.append(CsvUtils::cellKey(row, col));
     }
     return results;
 }
@@ -740,7 +2786,7 @@ QList<QString> QCsv::searchByPrefix(const QString& prefix) const {
 void QCsv::setSeparator(char sep) {
     if (sep != separator) {
         separator = sep;
-        if (!csvModel.isEmpty()) {
+        if (!storage.isEmpty()) {
             qWarning() << "Separator changed after loading data. Call load() again.";
         }
     }
@@ -748,7 +2794,7 @@ void QCsv::setSeparator(char sep) {
 
 // 流式读取操作符
 QCsv& operator>>(QCsv& csv, QString& value) {
-    if (!csv.fileStream) {
+    if (!csv.streamReader) {
         csv.openStream();
     }
     
@@ -757,174 +2803,66 @@ QCsv& operator>>(QCsv& csv, QString& value) {
         return csv;
     }
     
-    bool success = csv.readNextCell(value);
-    if (!success) {
-        csv.atEnd = true;
-        value.clear();
+    // 当前行的字段取完后再拉取下一行
+    while (csv.streamCol >= csv.streamReader->row().size()) {
+        if (!csv.streamReader->nextRow()) {
+            csv.atEnd = true;
+            value.clear();
+            return csv;
+        }
+        csv.streamCol = 0;
     }
     
+    // 复用 value 已有的容量
+    const QStringView field = csv.streamReader->row().field(csv.streamCol++);
+    value.setUnicode(field.data(), field.size());
     return csv;
 }
 
 // 流式读取辅助方法
 void QCsv::openStream() {
-    if (fileStream) return;
+    if (streamReader) return;
     
-    fileStream = std::make_unique<std::ifstream>(
-        filePath.toStdString(), std::ios::binary
-    );
-        
-    if (!fileStream->is_open()) {
+    auto reader = std::make_unique<CsvReader>(filePath, separator, streamOptions);
+    if (!reader->open()) {
         throw std::runtime_error("Could not open file stream: " + filePath.toStdString());
     }
     
-    buffer.resize(BUFFER_SIZE);
-    fileStream->rdbuf()->pubsetbuf(nullptr, 0);
-    
-    state = CsvParser::STATE_NORMAL;
-    pendingCR = false;
+    streamReader = std::move(reader);
+    streamCol = 0;
     atEnd = false;
-    currentRow = 0;
-    currentCol = 0;
-    currentCell.clear();
-    currentCell.reserve(64);
 }
 
 void QCsv::closeStream() {
-    if (fileStream) {
-        fileStream->close();
-        fileStream.reset();
-    }
+    streamReader.reset();
 }
 
 void QCsv::resetStream() {
     closeStream();
-    currentRow = 0;
-    currentCol = 0;
-    currentCell.clear();
-    state = CsvParser::STATE_NORMAL;
-    pendingCR = false;
+    streamCol = 0;
     atEnd = false;
 }
 
-bool QCsv::getNextChar(char& ch) {
-    if (bufferPos >= bufferSize) {
-        if (fileStream->eof()) return false;
-        
-        fileStream->read(buffer.data(), BUFFER_SIZE);
-        bufferSize = fileStream->gcount();
-        bufferPos = 0;
-        
-        if (bufferSize == 0) return false;
-    }
-    
-    ch = buffer[bufferPos++];
-    return true;
-}
-
-void QCsv::appendToCurrentCell(char ch) {
-    currentCell.append(ch);
-    if (currentCell.size() > currentCell.capacity() - 10) {
-        currentCell.reserve(currentCell.size() + 64);
-    }
+bool QCsv::hasNext() const {
+    return !atEnd;
 }
 
-bool QCsv::readNextCell(QString& result) {
-    if (!fileStream || !fileStream->is_open()) {
+bool QCsv::seekToCell(int row, int col) {
+    if (row < 1 || col < 1) {
         return false;
     }
-    
-    result.clear();
-    currentCell.clear();
-    
-    char ch;
-    while (getNextChar(ch)) {
-        switch (state) {
-            case CsvParser::STATE_NORMAL:
-                if (ch == '"') {
-                    state = CsvParser::STATE_IN_QUOTES;
-                } else if (ch == separator) {
-                    endCell();
-                    result = currentCell;
-                    return true;
-                } else if (ch == '\n') {
-                    if (!pendingCR) {
-                        endCell();
-                        endRow();
-                        result = currentCell;
-                        return true;
-                    }
-                    pendingCR = false;
-                } else if (ch == '\r') {
-                    pendingCR = true;
-                    endCell();
-                    endRow();
-                    result = currentCell;
-                    return true;
-                } else {
-                    appendToCurrentCell(ch);
-                }
-                break;
-                
-            case CsvParser::STATE_IN_QUOTES:
-                if (ch == '"') {
-                    state = CsvParser::STATE_QUOTE_IN_QUOTES;
-                } else {
-                    appendToCurrentCell(ch);
-                }
-                break;
-                
-            case CsvParser::STATE_QUOTE_IN_QUOTES:
-                if (ch == '"') {
-                    currentCell.append('"');
-                    state = CsvParser::STATE_IN_QUOTES;
-                } else if (ch == separator) {
-                    endCell();
-                    result = currentCell;
-                    return true;
-                } else if (ch == '\n') {
-                    endCell();
-                    endRow();
-                    result = currentCell;
-                    return true;
-                } else if (ch == '\r') {
-                    pendingCR = true;
-                    endCell();
-                    endRow();
-                    result = currentCell;
-                    return true;
-                } else {
-                    appendToCurrentCell(ch);
-                    state = CsvParser::STATE_NORMAL;
-                }
-                break;
-                
-            default:
-                break;
-        }
+    if (!streamReader) {
+        openStream();
     }
     
-    // 处理文件结束
-    if (!currentCell.isEmpty() || state != CsvParser::STATE_NORMAL) {
-        endCell();
-        result = currentCell;
-        return true;
+    if (!streamReader->seekToRow(row - 1) || !streamReader->nextRow()) {
+        atEnd = true;
+        return false;
     }
     
-    return false;
-}
-
-void QCsv::endCell() {
-    currentCol++;
-}
-
-void QCsv::endRow() {
-    currentRow++;
-    currentCol = 0;
-}
-
-bool QCsv::hasNext() const {
-    return !atEnd;
+    atEnd = false;
+    streamCol = col - 1;
+    return streamCol < streamReader->row().size();
 }
 
 void QCsv::enableHeaders(bool enable) {
@@ -940,11 +2878,7 @@ void QCsv::setHeaderRow(int row) {
 
 void QCsv::setColumnHeader(int col, const QString& header) {
     if (col < 1) throw std::invalid_argument("Column number must be >= 1");
-    if(header.isEmpty()) {
-        setValue(CsvUtils::numberToColumnRow(col - 1) + QString::number(headerRow), QString()); // 移除标题行的列标题
-    } else {
-        setValue(CsvUtils::numberToColumnRow(col - 1) + QString::number(headerRow), header); // 设置标题行的列标题
-    }
+    setCell(headerRow - 1, col - 1, header); // 空标题即移除标题行的列标题
 }
 
 void QCsv::setColumnHeaders(const QHash<int, QString>& headers) {
@@ -958,49 +2892,50 @@ void QCsv::setColumnHeaders(const QHash<int, QString>& headers) {
     }
     
     // 批量更新
-    QHash<QString, QString> batchValues;
     for (auto it = headers.begin(); it != headers.end(); ++it) {
-        QString key = CsvUtils::numberToColumnRow(it.key() - 1) + QString::number(headerRow);
-        batchValues.insert(key, it.value());
+        setCell(headerRow - 1, it.key() - 1, it.value());
     }
-    
-    // 使用批量设置方法（如果存在）
-    setValues(batchValues);  // 假设有这样的批量方法
 }
 
 QString QCsv::getColumnHeader(int col) const {
-    return csvModel.value(CsvUtils::numberToColumnRow(col - 1) + QString::number(headerRow));
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(headerRow - 1));
+    return cellValue(headerRow - 1, col - 1);
 }
 
 QList<QString> QCsv::getColumnHeaders() const {
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(headerRow - 1));
     QList<QString> headers;
     for (int col = 1; col <= maxCol; ++col) {
-        headers.append(getColumnHeader(col));
+        headers.append(cellValue(headerRow - 1, col - 1));
     }
     return headers;
 }
 
 QStringList QCsv::getColumnHeaderLists() const {
-    QStringList headerList;
-    for (int col = 1; col <= maxCol; ++col) {
-        headerList.append(getColumnHeader(col));
-    }
-    return headerList;
+    return getColumnHeaders();
 }
 
 QList<int> QCsv::searchColumnHeader(const QString& header) const {
     QList<int> results;
     if (header.isEmpty()) return results;
     
-    // 获取所有匹配的键
-    auto keys = searchModel.values(header);
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QMutexLocker index(indexLock());
+    if (lazy) {
+        // 懒加载模式不会开启并发锁，这里的逐列读取不会重入锁
+        for (int col = 1; col <= maxCol; ++col) {
+            if (getColumnHeader(col) == header) results.append(col);
+        }
+        return results;
+    }
     
-    // 遍历所有匹配的键，找到在标题行的那个
-    for (const QString& key : keys) {
-        auto [colPart, rowPart] = CsvUtils::splitKey(key);
-        if (rowPart  == headerRow - 1) {  // rowPart 是0-based，headerRow是1-based
-            // qDebug() << "Found header:" << header <<"match at key:" << key << "colPart:" << colPart << "rowPart:" << rowPart;
-            results.append(CsvUtils::columnRowToNumber(colPart) + 1);
+    // 遍历所有匹配的单元格，找到在标题行的那些
+    for (quint64 cell : findCells(header)) {
+        if (CsvUtils::cellRow(cell) == headerRow - 1) {  // 单元格行是0-based，headerRow是1-based
+            results.append(CsvUtils::cellColumn(cell) + 1);
         }
     }
     std::sort(results.begin(), results.end());
@@ -1016,11 +2951,7 @@ void QCsv::setHeaderColumn(int col) {
 
 void QCsv::setRowHeader(int row, const QString& header) {
     if (row < 1) throw std::invalid_argument("Row number must be >= 1");
-    if(header.isEmpty()) {
-        setValue(CsvUtils::numberToColumnRow(headerCol - 1) + QString::number(row), QString()); // 移除标题列的行标题
-    } else {
-        setValue(CsvUtils::numberToColumnRow(headerCol - 1) + QString::number(row), header); // 设置标题列的行标题
-    }
+    setCell(row - 1, headerCol - 1, header); // 空标题即移除标题列的行标题
 }
 
 void QCsv::setRowHeaders(const QHash<int, QString>& headers) {
@@ -1034,45 +2965,46 @@ void QCsv::setRowHeaders(const QHash<int, QString>& headers) {
     }
     
     // 批量更新
-    QHash<QString, QString> batchValues;
     for (auto it = headers.begin(); it != headers.end(); ++it) {
-        QString key = CsvUtils::numberToColumnRow(headerCol - 1) + QString::number(it.key());
-        batchValues.insert(key, it.value());
+        setCell(it.key() - 1, headerCol - 1, it.value());
     }
-    
-    // 使用批量设置方法（如果存在）
-    setValues(batchValues);  // 假设有这样的批量方法
 }
 
 QString QCsv::getRowHeader(int row) const {
-    return csvModel.value(CsvUtils::numberToColumnRow(headerCol - 1) + QString::number(row));
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row - 1));
+    return cellValue(row - 1, headerCol - 1);
 }
 
 QList<QString> QCsv::getRowHeaders() const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
     QList<QString> headers;
     for (int row = 1; row <= maxRow; ++row) {
-        headers.append(getRowHeader(row));
+        headers.append(cellValue(row - 1, headerCol - 1));
     }
     return headers;
 }
 
 QStringList QCsv::getRowHeaderLists() const {
-    QStringList headerList;
-    for (int row = 1; row <= maxRow; ++row) {
-        headerList.append(getRowHeader(row));
-    }
-    return headerList;
+    return getRowHeaders();
 }
 
 QList<int> QCsv::searchRowHeader(const QString& header) const {
     QList<int> results;
-    auto keys = searchModel.values(header);  // ✅ 获取所有匹配项
-    QString targetCol = CsvUtils::numberToColumnRow(headerCol - 1);
-    
-    for (const QString& key : keys) {
-        auto [colPart, rowPart] = CsvUtils::splitKey(key);
-        if (colPart == targetCol) {
-            results.append(rowPart + 1);
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QMutexLocker index(indexLock());
+    if (lazy) {
+        if (header.isEmpty()) return results;
+        for (int row = 1; row <= maxRow; ++row) {
+            if (getRowHeader(row) == header) results.append(row);
+        }
+        return results;
+    }
+    for (quint64 cell : findCells(header)) {  // ✅ 获取所有匹配项
+        if (CsvUtils::cellColumn(cell) == headerCol - 1) {
+            results.append(CsvUtils::cellRow(cell) + 1);
         }
     }
     // 排序
@@ -1118,13 +3050,462 @@ QMap<QString, QVariant> QCsv::getAllMetadata() const {
     return metadata;
 }
 
+// ==================== 类型化列 ====================
+
+void QCsv::inferColumnTypes() {
+    const int skipRow = headersOn ? headerRow - 1 : -1;
+    const size_t cols = static_cast<size_t>(maxCol);
+
+    // deferDecode 时映射中的 ASCII 单元格直接按字节解析，不解码整个块
+    auto forEachValue = [this](auto&& func) {
+        if (lazy) {
+            forEachCell([&func](int row, int col, QStringView value) { func(row, col, value); });
+            return;
+        }
+        storage.forEachRaw([&func](int row, int col, QStringView value, const char* utf8, qsizetype size) {
+            if (!utf8) {
+                func(row, col, value);
+            } else if (CsvSimd::isAscii(utf8, utf8 + size)) {
+                func(row, col, AsciiBytes{utf8, size});
+            } else {
+                const QString decoded = QString::fromUtf8(utf8, size);
+                func(row, col, QStringView(decoded));
+            }
+        });
+    };
+
+    // 第一遍：逐列排除解析失败的类型
+    std::vector<quint8> candidates(cols, CAN_ANY);
+    std::vector<quint8> seen(cols, 0);
+    forEachValue([&](int row, int col, auto value) {
+        if (row == skipRow || static_cast<size_t>(col) >= cols) return;
+        seen[col] = 1;
+        if (candidates[col]) candidates[col] = classify(value, candidates[col]);
+    });
+
+    auto columns = std::make_unique<TypedColumns>(maxCol);
+    bool anyTyped = false;
+    for (size_t col = 0; col < cols; ++col) {
+        TypedColumns::Column& column = columns->columns[col];
+        column.inferred = seen[col] ? typeFor(candidates[col]) : ColumnType::String;
+        column.type = column.inferred;
+        if (column.inferred == ColumnType::String) continue;
+        column.resize(static_cast<size_t>(maxRow));
+        anyTyped = true;
+    }
+
+    // 第二遍：解析进原生数组
+    if (anyTyped) {
+        forEachValue([&](int row, int col, auto value) {
+            if (row == skipRow || static_cast<size_t>(col) >= cols) return;
+            TypedColumns::Column& column = columns->columns[col];
+            if (column.inferred != ColumnType::String) column.store(row, value);
+        });
+    }
+    typed = std::move(columns);
+}
+
+void QCsv::updateTyped(int row, int col, const QString& value) {
+    if (col < 0 || static_cast<size_t>(col) >= typed->columns.size()) return;
+    if (headersOn && row == headerRow - 1) return;
+
+    TypedColumns::Column& column = typed->columns[col];
+    if (column.type.load(std::memory_order_relaxed) == ColumnType::String) return;
+    // 追加非空值时 updateMaxRowCol 已在整表独占锁下把所有类型化列扩展到 maxRow，
+    // 数组之外只剩写入空值的单元格，本就为空
+    if (static_cast<size_t>(row) >= column.rows()) return;
+
+    if (value.isEmpty()) {
+        column.erase(row);
+    } else if (!column.store(row, value)) {
+        column.type = ColumnType::String;
+    }
+}
+
+QCsv::ColumnType QCsv::getColumnType(int col) const {
+    QReadLocker table(tableLock());
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    return column ? column->type.load(std::memory_order_relaxed) : ColumnType::String;
+}
+
+std::optional<qint64> QCsv::getInt64(int row, int col) const {
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row - 1));
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (column && column->inferred == ColumnType::Int64 && row >= 1 && static_cast<size_t>(row - 1) < column->rows()) {
+        if (!column->has(row - 1)) return std::nullopt;
+        return column->ints[row - 1];
+    }
+    qint64 value = 0;
+    if (parseInt64(cellValue(row - 1, col - 1), value)) return value;
+    return std::nullopt;
+}
+
+std::optional<double> QCsv::getDouble(int row, int col) const {
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row - 1));
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (column && column->isNumeric() && row >= 1 && static_cast<size_t>(row - 1) < column->rows()) {
+        if (!column->has(row - 1)) return std::nullopt;
+        return column->doubles[row - 1];
+    }
+    double value = 0;
+    if (parseDouble(cellValue(row - 1, col - 1), value)) return value;
+    return std::nullopt;
+}
+
+std::optional<bool> QCsv::getBool(int row, int col) const {
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row - 1));
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (column && column->inferred == ColumnType::Bool && row >= 1 && static_cast<size_t>(row - 1) < column->rows()) {
+        if (!column->has(row - 1)) return std::nullopt;
+        return column->ints[row - 1] != 0;
+    }
+    bool value = false;
+    if (parseBool(cellValue(row - 1, col - 1), value)) return value;
+    return std::nullopt;
+}
+
+std::optional<QDate> QCsv::getDate(int row, int col) const {
+    QReadLocker table(tableLock());
+    QReadLocker shard(shardLock(row - 1));
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (column && column->inferred == ColumnType::Date && row >= 1 && static_cast<size_t>(row - 1) < column->rows()) {
+        if (!column->has(row - 1)) return std::nullopt;
+        return QDate::fromJulianDay(column->ints[row - 1]);
+    }
+    qint64 day = 0;
+    if (parseDate(cellValue(row - 1, col - 1), day)) return QDate::fromJulianDay(day);
+    return std::nullopt;
+}
+
+CsvColumnView<double> QCsv::columnAsDouble(int col) const {
+    if (locks) return CsvColumnView<double>();
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (!column || !column->usesDoubles()) return CsvColumnView<double>();
+    return CsvColumnView<double>(column->doubles.data(), static_cast<qsizetype>(column->doubles.size()),
+                                 column->valid.data());
+}
+
+CsvColumnView<qint64> QCsv::columnAsInt64(int col) const {
+    if (locks) return CsvColumnView<qint64>();
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (!column || !column->usesInts()) return CsvColumnView<qint64>();
+    return CsvColumnView<qint64>(column->ints.data(), static_cast<qsizetype>(column->ints.size()),
+                                 column->valid.data());
+}
+
+// ==================== 列聚合 ====================
+
+namespace {
+
+// 聚合的中间结果，m2 为与均值之差的平方和
+struct PartialAggregate {
+    qint64 count = 0;
+    double sum = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double m2 = 0;
+
+    double mean() const { return count ? sum / static_cast<double>(count) : 0; }
+
+    // 逐个累加（Welford）
+    void add(double value) {
+        const double delta = value - mean();
+        ++count;
+        sum += value;
+        m2 += delta * (value - mean());
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+
+    // 合并两个分块的结果（Chan 的并行方差公式）
+    void merge(const PartialAggregate& other) {
+        if (!other.count) return;
+        if (!count) {
+            *this = other;
+            return;
+        }
+        const double delta = other.mean() - mean();
+        const double total = static_cast<double>(count + other.count);
+        m2 += other.m2 + delta * delta * (static_cast<double>(count) * static_cast<double>(other.count) / total);
+        count += other.count;
+        sum += other.sum;
+        min = other.min < min ? other.min : min;
+        max = other.max > max ? other.max : max;
+    }
+
+    QCsv::Aggregate result() const {
+        QCsv::Aggregate aggregate;
+        if (!count) return aggregate;
+        aggregate.count = count;
+        aggregate.sum = sum;
+        aggregate.min = min;
+        aggregate.max = max;
+        aggregate.mean = mean();
+        aggregate.variance = m2 / static_cast<double>(count);
+        return aggregate;
+    }
+};
+
+// 两遍 SIMD 扫描：先求个数、和、最值，再求平方差。values[0] 对应 validity[0] 的第 0 位
+PartialAggregate aggregateDoubles(const double* values, const quint64* validity, size_t size) {
+    const uint64_t* bits = reinterpret_cast<const uint64_t*>(validity);
+    const CsvSimd::Moments moments = CsvSimd::moments(values, bits, size);
+    PartialAggregate part;
+    if (!moments.count) return part;
+    part.count = static_cast<qint64>(moments.count);
+    part.sum = moments.sum;
+    part.min = moments.min;
+    part.max = moments.max;
+    part.m2 = CsvSimd::squaredDeviations(values, bits, size, part.mean());
+    return part;
+}
+
+// 并行聚合中的一个分块，边界对齐到位图的字
+struct AggregateChunk {
+    size_t begin = 0;
+    size_t end = 0;
+    PartialAggregate part;
+};
+
+// 每个线程至少处理的行数，小列分块的调度开销会超过计算本身
+constexpr size_t PARALLEL_AGGREGATE_ROWS = size_t(1) << 16;
+
+} // namespace
+
+QCsv::Aggregate QCsv::aggregate(int col, int threads) const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    if (col < 1 || col > maxCol) return Aggregate();
+
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (!column || !column->isNumeric()) {
+        PartialAggregate part;
+        forEachInColumn(col - 1, [&part](int, QStringView value) {
+            double number = 0;
+            if (parseDouble(value, number)) part.add(number);
+        });
+        return part.result();
+    }
+
+    const double* values = column->doubles.data();
+    const quint64* validity = column->valid.data();
+    const size_t size = column->doubles.size();
+    if (threads <= 0) threads = std::max(1, QThread::idealThreadCount());
+    const size_t count = std::min(static_cast<size_t>(threads), size / PARALLEL_AGGREGATE_ROWS);
+    if (count <= 1) return aggregateDoubles(values, validity, size).result();
+
+    const size_t step = ((size + count - 1) / count + 63) & ~size_t(63);
+    std::vector<AggregateChunk> chunks;
+    for (size_t begin = 0; begin < size; begin += step) {
+        AggregateChunk chunk;
+        chunk.begin = begin;
+        chunk.end = std::min(begin + step, size);
+        chunks.push_back(chunk);
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(static_cast<int>(chunks.size()));
+    QtConcurrent::blockingMap(&pool, chunks, [values, validity](AggregateChunk& chunk) {
+        chunk.part = aggregateDoubles(values + chunk.begin, validity + chunk.begin / 64, chunk.end - chunk.begin);
+    });
+
+    PartialAggregate total;
+    for (const AggregateChunk& chunk : chunks) {
+        total.merge(chunk.part);
+    }
+    return total.result();
+}
+
+QHash<QString, QCsv::Aggregate> QCsv::aggregateBy(int col, int groupCol) const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QHash<QString, Aggregate> results;
+    if (col < 1 || col > maxCol || groupCol < 1) return results;
+
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (column && !column->isNumeric()) column = nullptr;
+    const int skipRow = headersOn ? headerRow - 1 : -1;
+
+    // 每行都登记分组，没有数值的分组 count 为 0
+    QHash<QString, PartialAggregate> groups;
+    for (int row = 0; row < maxRow; ++row) {
+        if (row == skipRow) continue;
+        PartialAggregate& group = groups[cellValue(row, groupCol - 1)];
+        double number = 0;
+        if (column && static_cast<size_t>(row) < column->rows()) {
+            if (!column->has(row)) continue;
+            number = column->doubles[row];
+        } else if (!parseDouble(cellValue(row, col - 1), number)) {
+            continue;
+        }
+        group.add(number);
+    }
+
+    results.reserve(groups.size());
+    for (auto it = groups.cbegin(); it != groups.cend(); ++it) {
+        results.insert(it.key(), it.value().result());
+    }
+    return results;
+}
+
+double QCsv::sum(int col) const {
+    return aggregate(col).sum;
+}
+
+std::optional<double> QCsv::min(int col) const {
+    const Aggregate result = aggregate(col);
+    if (!result.count) return std::nullopt;
+    return result.min;
+}
+
+std::optional<double> QCsv::max(int col) const {
+    const Aggregate result = aggregate(col);
+    if (!result.count) return std::nullopt;
+    return result.max;
+}
+
+std::optional<double> QCsv::mean(int col) const {
+    const Aggregate result = aggregate(col);
+    if (!result.count) return std::nullopt;
+    return result.mean;
+}
+
+std::optional<double> QCsv::variance(int col) const {
+    const Aggregate result = aggregate(col);
+    if (!result.count) return std::nullopt;
+    return result.variance;
+}
+
+qint64 QCsv::count(int col) const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    if (col < 1 || col > maxCol) return 0;
+
+    // 类型化列的非空单元格都已解析成功，非空位图即可计数
+    qint64 result = 0;
+    if (const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr) {
+        for (quint64 word : column->valid) {
+            result += qPopulationCount(word);
+        }
+        return result;
+    }
+    forEachInColumn(col - 1, [&result](int, QStringView) { ++result; });
+    return result;
+}
+
+qint64 QCsv::countDistinct(int col) const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    if (col < 1 || col > maxCol) return 0;
+
+    const TypedColumns::Column* column = typed ? typed->find(col - 1) : nullptr;
+    if (column && column->usesInts()) {
+        std::unordered_set<qint64> values;
+        for (size_t row = 0; row < column->ints.size(); ++row) {
+            if (column->has(static_cast<int>(row))) values.insert(column->ints[row]);
+        }
+        return static_cast<qint64>(values.size());
+    }
+    if (column) {
+        std::unordered_set<double> values;
+        for (size_t row = 0; row < column->doubles.size(); ++row) {
+            if (column->has(static_cast<int>(row))) values.insert(column->doubles[row] + 0.0);  // -0 与 +0 视为同一值
+        }
+        return static_cast<qint64>(values.size());
+    }
+
+    QSet<QString> values;
+    forEachInColumn(col - 1, [&values](int, QStringView value) { values.insert(value.toString()); });
+    return values.size();
+}
+
+// ==================== 过滤 ====================
+
+CsvRowSelection QCsv::filter(const CsvPredicate& predicate) const {
+    QReadLocker table(tableLock());
+    ShardsReadLocker shards(shardLocks(), Locks::SHARDS);
+    QMutexLocker index(indexLock());
+
+    CsvRowSelection selection(maxRow);
+    if (predicate.node) {
+        selectRows(*predicate.node, selection);
+    } else {
+        std::fill(selection.bitmap().begin(), selection.bitmap().end(), ~quint64(0));
+        selection.resize(maxRow);
+    }
+    if (headersOn) selection.deselect(headerRow - 1);
+    return selection;
+}
+
+QList<int> QCsv::findRows(const CsvPredicate& predicate) const {
+    QList<int> rows;
+    const CsvRowSelection selection = filter(predicate);
+    rows.reserve(static_cast<qsizetype>(selection.count()));
+    for (qint64 row : selection.toRowIds()) {
+        rows.append(static_cast<int>(row) + 1);
+    }
+    return rows;
+}
+
+// 逐列求值：每个叶子条件扫描一列得到位图，再按 AND / OR 合并。out 须为全 0、覆盖 maxRow 行
+void QCsv::selectRows(const CsvPredicate::Node& node, CsvRowSelection& out) const {
+    using Kind = CsvPredicate::Node::Kind;
+    if (!node.isLeaf()) {
+        selectRows(*node.left, out);
+        if (node.kind == Kind::And && out.isEmpty()) return;  // 左侧为空，不必再求右侧
+        CsvRowSelection right(out.size());
+        selectRows(*node.right, right);
+        if (node.kind == Kind::And) {
+            out &= right;
+        } else {
+            out |= right;
+        }
+        return;
+    }
+
+    const int col = node.col - 1;
+    if (col < 0 || col >= maxCol) return;
+    quint64* words = out.bitmap().data();
+    auto mark = [words](int row) { words[row >> 6] |= quint64(1) << (row & 63); };
+
+    // 类型化数值列：SIMD 区间比较直接写出位图
+    const TypedColumns::Column* column = typed ? typed->find(col) : nullptr;
+    if (node.kind == Kind::Range && column && column->isNumeric()) {
+        const size_t rows = std::min(column->doubles.size(), static_cast<size_t>(out.size()));
+        CsvSimd::selectRange(column->doubles.data(), reinterpret_cast<const uint64_t*>(column->valid.data()), rows,
+                             node.low, node.high, reinterpret_cast<uint64_t*>(words));
+        return;
+    }
+
+    // 搜索索引已建立时，== 与 IN 只取出匹配的单元格，不扫描整列
+    const SearchIndex& index = *searchIndex;
+    const bool indexReady = !lazy && index.kind == loadOptions.searchIndexKind &&
+                            (index.kind == SearchIndexKind::Sorted ? index.sortedValid : index.built);
+    if (indexReady && (node.kind == Kind::Equals || node.kind == Kind::In)) {
+        const QStringList values = node.kind == Kind::Equals ? QStringList{node.text} : node.values;
+        for (const QString& value : values) {
+            if (value.isEmpty()) continue;
+            for (quint64 cell : findCells(value)) {
+                if (CsvUtils::cellColumn(cell) == col) mark(CsvUtils::cellRow(cell));
+            }
+        }
+        return;
+    }
+
+    forEachInColumn(col, [&node, &mark](int row, QStringView value) {
+        if (node.matches(value)) mark(row);
+    });
+}
+
 // ==================== 类型判断&&转换 ====================
 
 //判断
 bool QCsv::isNumeric(const QString& value) const {
-    bool ok;
-    value.toDouble(&ok);
-    return ok;
+    double number = 0;
+    return CsvNumber::parseDouble(QStringView(value), number);
 }
 
 bool QCsv::isDate(const QString& value, const QString& format) const {
@@ -1138,9 +3519,8 @@ bool QCsv::isBoolean(const QString& value) const {
 
 //转换
 std::optional<double> QCsv::toDouble(const QString& value) const {
-    bool ok;
-    double result = value.toDouble(&ok);
-    if (ok) {
+    double result = 0;
+    if (CsvNumber::parseDouble(QStringView(value), result)) {
         return result;
     }
     return std::nullopt;
@@ -1164,30 +3544,3 @@ std::optional<bool> QCsv::toBoolean(const QString& value) const {
     return std::nullopt;
 }
 
-#if EXPERIMENTAL_FUNC
-bool QCsv::seekToCell(int targetRow, int targetCol) {
-    if (!fileStream || !fileStream->is_open()) {
-        return false;
-    }
-    
-    if (targetRow < 0 || targetCol < 0) {
-        return false;
-    }
-    
-    if (targetRow < currentRow || (targetRow == currentRow && targetCol < currentCol)) {
-        resetStream();
-    }
-    
-    QString cellValue;
-    while (currentRow <= targetRow) {
-        currentCol = 0;
-        while (currentCol <= targetCol) {
-            if (!readNextCell(cellValue)) {
-                return false;
-            }
-        }
-    }
-    
-    return true;
-}
-#endif
\ No newline at end of file
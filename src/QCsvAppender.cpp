@@ -0,0 +1,140 @@
+#include "QCsv.hpp"
+#include "QCsvWriter.hpp"
+#include <QFile>
+#include <chrono>
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <io.h>
+#endif
+
+namespace {
+
+qint64 monotonicMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+QCsvAppender::QCsvAppender(const QString& filePath)
+    : QCsvAppender(filePath, Options()) {}
+
+QCsvAppender::QCsvAppender(const QString& filePath, const Options& options)
+    : filePath(filePath), options(options) {}
+
+QCsvAppender::~QCsvAppender() {
+    close();
+}
+
+bool QCsvAppender::open() {
+    if (isOpen()) return true;
+    if (filePath.isEmpty()) {
+        lastError = "File path cannot be empty";
+        return false;
+    }
+
+    // 只看最后一个字节，与文件大小无关
+    bool needsNewline = false;
+    {
+        QFile tail(filePath);
+        if (tail.exists() && tail.size() > 0 && tail.open(QIODevice::ReadOnly) && tail.seek(tail.size() - 1)) {
+            char last = '\n';
+            needsNewline = tail.getChar(&last) && last != '\n';
+        }
+    }
+
+    // 写入器已经按大块缓冲，文件本身不再缓冲
+    auto target = std::make_unique<QFile>(filePath);
+    if (!target->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        lastError = "Could not open file for appending: " + filePath;
+        return false;
+    }
+
+    file = std::move(target);
+    writer = std::make_unique<CsvWriter>(*file, options.separator, options.bufferSize);
+    if (needsNewline) writer->endRow();
+    rowsSinceSync = 0;
+    lastSync = monotonicMs();
+    return true;
+}
+
+void QCsvAppender::close() {
+    if (!isOpen()) return;
+    if (options.groupCommitRows > 0 || options.groupCommitInterval > 0) {
+        sync();
+    } else {
+        flush();
+    }
+    writer.reset();
+    file->close();
+    file.reset();
+}
+
+template<typename Fields>
+bool QCsvAppender::appendFields(const Fields& fields) {
+    if (!isOpen() && !open()) return false;
+
+    bool first = true;
+    for (const QString& field : fields) {
+        if (!first) writer->writeSeparator();
+        writer->writeField(field);
+        first = false;
+    }
+    writer->endRow();
+    ++rows;
+    ++rowsSinceSync;
+
+    if (writer->hasError()) {
+        lastError = "Could not write to file: " + filePath;
+        return false;
+    }
+    return groupCommitDue() ? sync() : true;
+}
+
+bool QCsvAppender::appendRow(const std::vector<QString>& fields) {
+    return appendFields(fields);
+}
+
+bool QCsvAppender::appendRow(const QStringList& fields) {
+    return appendFields(fields);
+}
+
+bool QCsvAppender::appendRows(const QList<QStringList>& rows) {
+    for (const QStringList& fields : rows) {
+        if (!appendFields(fields)) return false;
+    }
+    return true;
+}
+
+bool QCsvAppender::groupCommitDue() const {
+    if (options.groupCommitRows > 0 && rowsSinceSync >= options.groupCommitRows) return true;
+    return options.groupCommitInterval > 0 && monotonicMs() - lastSync >= options.groupCommitInterval;
+}
+
+bool QCsvAppender::flush() {
+    if (!isOpen()) return false;
+    if (!writer->flush()) {
+        lastError = "Could not write to file: " + filePath;
+        return false;
+    }
+    return true;
+}
+
+bool QCsvAppender::sync() {
+    if (!flush()) return false;
+
+    bool synced = true;
+#if defined(Q_OS_UNIX)
+    synced = ::fsync(file->handle()) == 0;
+#elif defined(Q_OS_WIN)
+    synced = ::_commit(file->handle()) == 0;
+#endif
+    rowsSinceSync = 0;
+    lastSync = monotonicMs();
+    if (!synced) {
+        lastError = "Could not sync file to disk: " + filePath;
+    }
+    return synced;
+}
@@ -0,0 +1,191 @@
+#include "QCsvFilter.hpp"
+#include "QCsvNumber.hpp"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// ==================== CsvRowSelection ====================
+
+qint64 CsvRowSelection::count() const {
+    qint64 result = 0;
+    for (quint64 word : words) {
+        result += qPopulationCount(word);
+    }
+    return result;
+}
+
+void CsvRowSelection::select(qint64 row) {
+    if (row < 0) return;
+    if (row >= total) {
+        total = row + 1;
+        words.resize(static_cast<size_t>((total + 63) / 64));
+    }
+    words[row >> 6] |= quint64(1) << (row & 63);
+}
+
+void CsvRowSelection::deselect(qint64 row) {
+    if (row < 0 || row >= total) return;
+    words[row >> 6] &= ~(quint64(1) << (row & 63));
+}
+
+void CsvRowSelection::resize(qint64 rows) {
+    total = std::max<qint64>(rows, 0);
+    words.resize(static_cast<size_t>((total + 63) / 64));
+    if (total & 63) words.back() &= (quint64(1) << (total & 63)) - 1;
+}
+
+std::vector<qint64> CsvRowSelection::toRowIds() const {
+    std::vector<qint64> rows;
+    rows.reserve(static_cast<size_t>(count()));
+    for (size_t w = 0; w < words.size(); ++w) {
+        for (quint64 word = words[w]; word; word &= word - 1) {
+            rows.push_back(static_cast<qint64>(w) * 64 + qCountTrailingZeroBits(word));
+        }
+    }
+    return rows;
+}
+
+CsvRowSelection& CsvRowSelection::operator&=(const CsvRowSelection& other) {
+    const size_t shared = std::min(words.size(), other.words.size());
+    for (size_t w = 0; w < shared; ++w) {
+        words[w] &= other.words[w];
+    }
+    std::fill(words.begin() + static_cast<std::ptrdiff_t>(shared), words.end(), 0);
+    return *this;
+}
+
+CsvRowSelection& CsvRowSelection::operator|=(const CsvRowSelection& other) {
+    if (other.total > total) {
+        total = other.total;
+        words.resize(other.words.size());
+    }
+    for (size_t w = 0; w < other.words.size(); ++w) {
+        words[w] |= other.words[w];
+    }
+    return *this;
+}
+
+// ==================== CsvPredicate ====================
+
+namespace {
+
+std::shared_ptr<CsvPredicate::Node> leaf(CsvPredicate::Node::Kind kind, int col) {
+    auto node = std::make_shared<CsvPredicate::Node>();
+    node->kind = kind;
+    node->col = col;
+    return node;
+}
+
+std::shared_ptr<CsvPredicate::Node> rangeNode(int col, double low, double high) {
+    auto node = leaf(CsvPredicate::Node::Kind::Range, col);
+    node->low = low;
+    node->high = high;
+    return node;
+}
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+bool CsvPredicate::Node::matches(QStringView value) const {
+    switch (kind) {
+        case Kind::Equals:
+            return value == text;
+        case Kind::In: {
+            auto it = std::lower_bound(values.cbegin(), values.cend(), value,
+                                       [](const QString& item, QStringView target) { return QStringView(item).compare(target) < 0; });
+            return it != values.cend() && QStringView(*it) == value;
+        }
+        case Kind::Range: {
+            double number = 0;
+            return CsvNumber::parseDouble(value, number) && number >= low && number <= high;
+        }
+        case Kind::Prefix:
+            return value.startsWith(text);
+        case Kind::Contains:
+            return value.contains(text, cs);
+        case Kind::Regex:
+            return pattern.match(value).hasMatch();
+        default:
+            return false;
+    }
+}
+
+CsvPredicate CsvPredicate::equals(int col, const QString& value) {
+    auto node = leaf(Node::Kind::Equals, col);
+    node->text = value;
+    return CsvPredicate(std::move(node));
+}
+
+CsvPredicate CsvPredicate::in(int col, const QStringList& values) {
+    auto node = leaf(Node::Kind::In, col);
+    node->values = values;
+    std::sort(node->values.begin(), node->values.end());
+    node->values.erase(std::unique(node->values.begin(), node->values.end()), node->values.end());
+    return CsvPredicate(std::move(node));
+}
+
+CsvPredicate CsvPredicate::less(int col, double value) {
+    return CsvPredicate(rangeNode(col, -INF, std::nextafter(value, -INF)));
+}
+
+CsvPredicate CsvPredicate::lessEqual(int col, double value) {
+    return CsvPredicate(rangeNode(col, -INF, value));
+}
+
+CsvPredicate CsvPredicate::greater(int col, double value) {
+    return CsvPredicate(rangeNode(col, std::nextafter(value, INF), INF));
+}
+
+CsvPredicate CsvPredicate::greaterEqual(int col, double value) {
+    return CsvPredicate(rangeNode(col, value, INF));
+}
+
+CsvPredicate CsvPredicate::range(int col, double low, double high) {
+    return CsvPredicate(rangeNode(col, low, high));
+}
+
+CsvPredicate CsvPredicate::prefix(int col, const QString& prefix) {
+    auto node = leaf(Node::Kind::Prefix, col);
+    node->text = prefix;
+    return CsvPredicate(std::move(node));
+}
+
+CsvPredicate CsvPredicate::contains(int col, const QString& text, Qt::CaseSensitivity cs) {
+    auto node = leaf(Node::Kind::Contains, col);
+    node->text = text;
+    node->cs = cs;
+    return CsvPredicate(std::move(node));
+}
+
+CsvPredicate CsvPredicate::regex(int col, const QRegularExpression& pattern) {
+    auto node = leaf(Node::Kind::Regex, col);
+    node->pattern = pattern;
+    return CsvPredicate(std::move(node));
+}
+
+CsvPredicate CsvPredicate::operator&&(const CsvPredicate& other) const {
+    if (!node) return other;
+    if (!other.node) return *this;
+    auto combined = std::make_shared<Node>();
+    combined->kind = Node::Kind::And;
+    combined->left = node;
+    combined->right = other.node;
+    return CsvPredicate(std::move(combined));
+}
+
+CsvPredicate CsvPredicate::operator||(const CsvPredicate& other) const {
+    // 空条件匹配所有行
+    if (!node) return *this;
+    if (!other.node) return other;
+    auto combined = std::make_shared<Node>();
+    combined->kind = Node::Kind::Or;
+    combined->left = node;
+    combined->right = other.node;
+    return CsvPredicate(std::move(combined));
+}
+
+bool CsvPredicate::matches(const CsvReader::Row& row) const {
+    return !node || node->matchesRow(row);
+}
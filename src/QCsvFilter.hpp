@@ -0,0 +1,49 @@
+#pragma once
+#include "QCsv.hpp"
+#include <QRegularExpression>
+#include <QStringList>
+#include <memory>
+
+// CsvPredicate 的条件树
+// 数值比较统一表示为闭区间：开端点在构造时换成相邻的可表示值，求值时只需 low <= x <= high。
+// 本头文件仅供库内部使用，不安装。
+struct CsvPredicate::Node {
+    enum class Kind {
+        Equals,
+        In,
+        Range,
+        Prefix,
+        Contains,
+        Regex,
+        And,
+        Or
+    };
+
+    Kind kind = Kind::Equals;
+    int col = 0;                                // 叶子条件的列（1-based）
+    QString text;                               // Equals / Prefix / Contains
+    Qt::CaseSensitivity cs = Qt::CaseSensitive;
+    QStringList values;                         // In，已排序去重
+    double low = 0;
+    double high = 0;
+    QRegularExpression pattern;
+    std::shared_ptr<const Node> left;           // And / Or
+    std::shared_ptr<const Node> right;
+
+    bool isLeaf() const { return kind != Kind::And && kind != Kind::Or; }
+
+    // 叶子条件对单个非空单元格求值
+    bool matches(QStringView value) const;
+    // 对一行求值，row 为 0-based 列的字段访问器
+    template<typename Row>
+    bool matchesRow(const Row& row) const {
+        switch (kind) {
+            case Kind::And: return left->matchesRow(row) && right->matchesRow(row);
+            case Kind::Or: return left->matchesRow(row) || right->matchesRow(row);
+            default: {
+                const QStringView value = row.field(col - 1);
+                return !value.isEmpty() && matches(value);
+            }
+        }
+    }
+};
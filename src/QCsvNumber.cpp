@@ -0,0 +1,92 @@
+#include "QCsvNumber.hpp"
+#include "QCsvSimd.hpp"
+#include <QByteArray>
+#include <charconv>
+
+// libstdc++ 11、MSVC 2019 起支持浮点 from_chars；更早的标准库退回 Qt 的解析
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    #define QTCSV_FLOAT_FROM_CHARS 1
+#else
+    #define QTCSV_FLOAT_FROM_CHARS 0
+#endif
+
+namespace CsvNumber {
+
+namespace {
+
+// 超过该长度的数字很少见，直接交给 Qt
+constexpr qsizetype NARROW_BUFFER = 64;
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// 去掉首尾空白和前导 '+'，from_chars 不接受这两者
+bool trim(const char*& begin, const char*& end) {
+    while (begin < end && isSpace(*begin)) ++begin;
+    while (end > begin && isSpace(end[-1])) --end;
+    if (begin < end && *begin == '+') {
+        ++begin;
+        if (begin < end && *begin == '-') return false;
+    }
+    return begin < end;
+}
+
+template<typename T>
+bool fromChars(const char* begin, const char* end, T& out) {
+    T value{};
+    const std::from_chars_result result = std::from_chars(begin, end, value);
+    if (result.ec != std::errc() || result.ptr != end) return false;
+    out = value;
+    return true;
+}
+
+// 收窄到 buffer，非 ASCII 或超长时返回 false
+bool narrow(QStringView value, char* buffer) {
+    if (value.size() > NARROW_BUFFER) return false;
+    const size_t size = static_cast<size_t>(value.size());
+    return CsvSimd::narrowAscii(value.utf16(), size, buffer) == size;
+}
+
+} // namespace
+
+bool parseInt64(const char* begin, const char* end, qint64& out) {
+    if (!trim(begin, end)) return false;
+    long long value = 0;
+    if (!fromChars(begin, end, value)) return false;
+    out = value;
+    return true;
+}
+
+bool parseDouble(const char* begin, const char* end, double& out) {
+    if (!trim(begin, end)) return false;
+#if QTCSV_FLOAT_FROM_CHARS
+    return fromChars(begin, end, out);
+#else
+    bool ok = false;
+    const double value = QByteArray::fromRawData(begin, end - begin).toDouble(&ok);
+    if (ok) out = value;
+    return ok;
+#endif
+}
+
+bool parseInt64(QStringView value, qint64& out) {
+    char buffer[NARROW_BUFFER];
+    if (narrow(value, buffer)) return parseInt64(buffer, buffer + value.size(), out);
+    // 全角空白等 Qt 认可的非 ASCII 空白
+    bool ok = false;
+    const qint64 result = value.toLongLong(&ok);
+    if (ok) out = result;
+    return ok;
+}
+
+bool parseDouble(QStringView value, double& out) {
+    char buffer[NARROW_BUFFER];
+    if (narrow(value, buffer)) return parseDouble(buffer, buffer + value.size(), out);
+    bool ok = false;
+    const double result = value.toDouble(&ok);
+    if (ok) out = result;
+    return ok;
+}
+
+} // namespace CsvNumber
@@ -0,0 +1,17 @@
+#pragma once
+#include <QStringView>
+
+// 数值单元格解析
+// 直接在 ASCII 字节上用 std::from_chars 解析（正确舍入，往返无损），不经过 QString 与本地化。
+// 与 QString::toDouble / toLongLong 一样忽略首尾空白、接受前导 '+'。
+// 本头文件仅供库内部使用，不安装。
+
+namespace CsvNumber {
+    // 整个区间须为一个数字，否则返回 false；溢出视为失败
+    bool parseInt64(const char* begin, const char* end, qint64& out);
+    bool parseDouble(const char* begin, const char* end, double& out);
+
+    // UTF-16 版本：ASCII 文本收窄后走字节路径，其余交给 Qt
+    bool parseInt64(QStringView value, qint64& out);
+    bool parseDouble(QStringView value, double& out);
+}
@@ -0,0 +1,403 @@
+#include "QCsv.hpp"
+#include "QCsvFilter.hpp"
+#include "QCsvSimd.hpp"
+#include "QCsvSource.hpp"
+#include "QCsvTokenizer.hpp"
+#include <QDebug>
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringDecoder>
+#include <algorithm>
+#include <cstring>
+
+// ==================== CsvReader::Row 实现 ====================
+
+QStringView CsvReader::Row::field(int col) const {
+    if (col < 0 || col >= size()) return QStringView();
+    const Field& f = fields[static_cast<size_t>(col)];
+    return QStringView(text.data() + f.offset, f.length);
+}
+
+QStringList CsvReader::Row::toStringList() const {
+    QStringList result;
+    result.reserve(size());
+    for (QStringView value : *this) {
+        result.append(value.toString());
+    }
+    return result;
+}
+
+// ==================== CsvReader 实现 ====================
+
+CsvReader::CsvReader(const QString& filePath, char separator)
+    : CsvReader(filePath, separator, Options()) {}
+
+CsvReader::CsvReader(const QString& filePath, char separator, const Options& options)
+    : filePath(filePath), separator(separator), options(options) {}
+
+CsvReader::~CsvReader() {
+    close();
+}
+
+bool CsvReader::open() {
+    if (source) return true;
+    if (filePath.isEmpty()) {
+        lastError = "File path cannot be empty";
+        return false;
+    }
+
+    auto opened = CsvSource::create(options.backend, static_cast<size_t>(options.bufferSize));
+    if (!opened->open(filePath)) {
+        lastError = opened->errorString();
+        return false;
+    }
+
+    source = std::move(opened);
+    structural.reserve(64 * 1024);
+    fieldBytes.reserve(256);
+    reset();
+
+    rowStarts.clear();
+    indexedRows = -1;
+    if (options.indexStride > 0 && !(options.persistIndex && loadIndex())) {
+        rowStarts.assign(1, 0);
+    }
+    return true;
+}
+
+void CsvReader::close() {
+    source.reset();
+    window = nullptr;
+}
+
+bool CsvReader::rewind() {
+    if (!source) return open();
+    return seekToRow(0);
+}
+
+bool CsvReader::seekToRow(qint64 row) {
+    if (!source && !open()) return false;
+    if (row < 0 || (indexedRows >= 0 && row > indexedRows)) return false;
+
+    if (indexCR) {
+        // 还不知道 CR 之后是否紧跟 LF，这个索引点不可靠，之后扫描到时再记录
+        rowStarts.pop_back();
+        indexCR = false;
+    }
+
+    qint64 startRow = 0;
+    quint64 offset = 0;
+    if (options.indexStride > 0 && !rowStarts.empty()) {
+        const size_t k = std::min(static_cast<size_t>(row / options.indexStride), rowStarts.size() - 1);
+        startRow = static_cast<qint64>(k) * options.indexStride;
+        offset = rowStarts[k];
+    }
+
+    // 目标在当前位置之后且当前位置不比索引点远时，直接向后解析
+    if (finished || rows > row || rows < startRow || row == 0) {
+        if (!source->seek(offset)) {
+            lastError = source->errorString();
+            return false;
+        }
+        reset();
+        windowOffset = offset;
+        rows = startRow;
+    }
+
+    skipping = true;
+    while (rows < row && nextRow()) {}
+    skipping = false;
+
+    current.textSize = 0;
+    current.fields.clear();
+    current.rowNumber = -1;
+    return rows == row;
+}
+
+bool CsvReader::buildIndex() {
+    if (options.indexStride <= 0) {
+        lastError = "Row index requires indexStride > 0";
+        return false;
+    }
+    if (!source && !open()) return false;
+    if (indexedRows < 0) {
+        // 从已索引的最后一行开始扫描到文件末尾，扫描过程中补全索引
+        const qint64 last = static_cast<qint64>(rowStarts.size() - 1) * options.indexStride;
+        if (!seekToRow(last)) return false;
+        skipping = true;
+        while (nextRow()) {}
+        skipping = false;
+        if (!lastError.isEmpty()) return false;
+    }
+    return rewind();
+}
+
+void CsvReader::reset() {
+    windowOffset = 0;
+    indexCR = false;
+    window = nullptr;
+    dataEnd = 0;
+    fieldStart = 0;
+    crNext = NONE;
+    structural.clear();
+    scanBase = 0;
+    nextStructural = 0;
+    fieldBytes.resize(0);
+    state = CsvQuoteState::Normal;
+    eof = false;
+    finished = false;
+    rows = 0;
+    current.textSize = 0;
+    current.fields.clear();
+    current.rowNumber = -1;
+    lastError.clear();
+}
+
+bool CsvReader::fill() {
+    if (eof) return false;
+
+    // 之前的字节都已处理，只有当前字段剩余的字节需要保留到下一块
+    const size_t keep = dataEnd - fieldStart;
+    const char* data = nullptr;
+    size_t size = 0;
+    source->next(keep, data, size);
+
+    crNext = (crNext != NONE && crNext >= fieldStart) ? crNext - fieldStart : NONE;
+    windowOffset += fieldStart;
+    fieldStart = 0;
+    window = data;
+    dataEnd = size;
+    if (size == keep) {
+        lastError = source->errorString();
+        eof = true;
+        return false;
+    }
+
+    // 只扫描新读入的字节：保留下来的字节中的结构字符都已处理过
+    structural.clear();
+    CsvSimd::findStructural(window + keep, window + size, separator, structural);
+    scanBase = keep;
+    nextStructural = 0;
+    return true;
+}
+
+bool CsvReader::nextRow() {
+    if (!source && !open()) return false;
+    if (finished) return false;
+
+    current.textSize = 0;
+    current.fields.clear();  // 保留容量
+
+    struct Sink {
+        CsvReader& reader;
+        bool rowEnded = false;
+        void append(const char* begin, const char* end) { reader.fieldBytes.append(begin, end - begin); }
+        void quoted() {}
+        void field(const char* begin, const char* end) { reader.endField(begin, end); }
+        bool row(const char* next, bool cr) {
+            reader.current.rowNumber = reader.rows++;
+            reader.indexCR = false;
+            if (reader.options.indexStride > 0) reader.recordRowStart(reader.windowOffset + (next - reader.window), cr);
+            rowEnded = true;
+            return true;
+        }
+        void crlf(const char* next) {
+            // 行已在 CR 处结束，下一行从 LF 之后开始
+            if (reader.indexCR) {
+                reader.rowStarts.back() = reader.windowOffset + (next - reader.window);
+                reader.indexCR = false;
+            }
+        }
+    } sink{*this};
+
+    do {
+        if (nextStructural < structural.size()) {
+            CsvTokenizer::Cursor cursor{window + fieldStart, crNext != NONE ? window + crNext : nullptr};
+            nextStructural += CsvTokenizer::withDialect(separator, [&](auto dialect) {
+                return CsvTokenizer::tokenize(dialect, state, cursor, window + scanBase, structural.data() + nextStructural,
+                                              structural.size() - nextStructural, sink);
+            });
+            fieldStart = static_cast<size_t>(cursor.fieldStart - window);
+            crNext = cursor.crNext ? static_cast<size_t>(cursor.crNext - window) : NONE;
+            if (sink.rowEnded) return true;
+        }
+    } while (fill());
+
+    // 文件结束：最后一行没有换行时补上
+    if (state == CsvQuoteState::InQuotes) {
+        qWarning() << "CSV file ended inside quoted field";
+    }
+    if (fieldStart < dataEnd || !fieldBytes.isEmpty() || state != CsvQuoteState::Normal || !current.fields.empty()) {
+        endField(window + fieldStart, window + dataEnd);
+        fieldStart = dataEnd;
+        state = CsvQuoteState::Normal;
+        current.rowNumber = rows++;
+        return true;
+    }
+
+    finished = true;
+    if (options.indexStride > 0 && indexedRows < 0 && lastError.isEmpty()) {
+        // 一直扫描到了文件末尾，索引已完整
+        indexedRows = rows;
+        if (options.persistIndex) saveIndex();
+    }
+    return false;
+}
+
+bool CsvReader::nextMatchingRow(const CsvPredicate& predicate) {
+    while (nextRow()) {
+        if (predicate.matches(current)) return true;
+    }
+    return false;
+}
+
+CsvRowSelection CsvReader::select(const CsvPredicate& predicate) {
+    CsvRowSelection selection;
+    while (nextMatchingRow(predicate)) {
+        selection.select(current.number());
+    }
+    // 末尾未选中的行也计入范围
+    if (rows > selection.size()) selection.resize(rows);
+    return selection;
+}
+
+void CsvReader::recordRowStart(quint64 offset, bool afterCR) {
+    // 只在索引末端追加，已索引的部分再次扫描时不重复记录
+    if (rows % options.indexStride != 0) return;
+    if (static_cast<size_t>(rows / options.indexStride) != rowStarts.size()) return;
+    rowStarts.push_back(offset);
+    indexCR = afterCR;
+}
+
+void CsvReader::endField(const char* begin, const char* end) {
+    if (skipping) {
+        // 定位时只需要知道行在哪里结束
+        current.fields.push_back({current.textSize, 0});
+        fieldBytes.resize(0);
+        return;
+    }
+
+    const char* data = begin;
+    qsizetype size = end - begin;
+    if (!fieldBytes.isEmpty()) {
+        fieldBytes.append(begin, size);
+        data = fieldBytes.constData();
+        size = fieldBytes.size();
+    }
+
+    // UTF-16 长度不超过 UTF-8 字节数，按字节数预留即可
+    std::vector<char16_t>& text = current.text;
+    const size_t offset = current.textSize;
+    if (offset + static_cast<size_t>(size) > text.size()) {
+        text.resize(std::max(text.size() * 2, offset + static_cast<size_t>(size)));
+    }
+    char16_t* const dst = text.data() + offset;
+
+    qsizetype length = size;
+    if (CsvSimd::isAscii(data, data + size)) {
+        for (qsizetype i = 0; i < size; ++i) {
+            dst[i] = static_cast<unsigned char>(data[i]);
+        }
+    } else {
+        QStringDecoder decoder(QStringConverter::Utf8, QStringConverter::Flag::Stateless);
+        QChar* const out = reinterpret_cast<QChar*>(dst);
+        length = decoder.appendToBuffer(out, QByteArrayView(data, size)) - out;
+    }
+
+    current.fields.push_back({offset, length});
+    current.textSize += static_cast<size_t>(length);
+    fieldBytes.resize(0);
+}
+
+CsvReader::IoBackend CsvReader::fastestBackend(const QString& filePath, char separator, qsizetype bufferSize) {
+    const IoBackend backends[] = {IoBackend::Buffered, IoBackend::MemoryMap, IoBackend::ReadAhead};
+
+    auto scan = [&](IoBackend backend) -> qint64 {
+        CsvReader reader(filePath, separator, Options{backend, bufferSize});
+        QElapsedTimer timer;
+        timer.start();
+        if (!reader.open()) return -1;
+        while (reader.nextRow()) {}
+        return timer.nsecsElapsed();
+    };
+
+    // 预读一遍，各后端都在同样的页缓存状态下比较
+    if (scan(IoBackend::Buffered) < 0) return IoBackend::Buffered;
+
+    IoBackend best = IoBackend::Buffered;
+    qint64 bestTime = -1;
+    for (IoBackend backend : backends) {
+        const qint64 elapsed = scan(backend);
+        if (elapsed >= 0 && (bestTime < 0 || elapsed < bestTime)) {
+            best = backend;
+            bestTime = elapsed;
+        }
+    }
+    return best;
+}
+
+// ==================== 行索引旁路文件 ====================
+
+namespace {
+
+constexpr quint32 INDEX_MAGIC = 0x51435849;   // "QCXI"
+constexpr quint32 INDEX_VERSION = 1;
+
+} // namespace
+
+QString CsvReader::indexPath() const {
+    return filePath + ".idx";
+}
+
+bool CsvReader::loadIndex() {
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    quint32 magic = 0, version = 0;
+    qint64 size = 0, modified = 0, total = 0;
+    qint8 sep = 0;
+    qint32 stride = 0;
+    quint64 count = 0;
+    in >> magic >> version >> size >> modified >> sep >> stride >> total >> count;
+
+    // 源文件的大小或修改时间变化后索引作废
+    const QFileInfo info(filePath);
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION
+        || size != info.size() || modified != info.lastModified().toMSecsSinceEpoch()
+        || sep != separator || stride != options.indexStride || total < 0
+        || count == 0 || count > static_cast<quint64>(total / stride + 1)) {
+        return false;
+    }
+
+    std::vector<quint64> offsets(static_cast<size_t>(count));
+    for (quint64& offset : offsets) {
+        in >> offset;
+    }
+    if (in.status() != QDataStream::Ok) return false;
+
+    rowStarts = std::move(offsets);
+    indexedRows = total;
+    return true;
+}
+
+bool CsvReader::saveIndex() const {
+    const QFileInfo info(filePath);
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << INDEX_MAGIC << INDEX_VERSION << info.size() << info.lastModified().toMSecsSinceEpoch()
+        << static_cast<qint8>(separator) << static_cast<qint32>(options.indexStride)
+        << indexedRows << static_cast<quint64>(rowStarts.size());
+    for (quint64 offset : rowStarts) {
+        out << offset;
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
@@ -0,0 +1,724 @@
+#include "QCsvSimd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define QTCSV_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#else
+    #define QTCSV_SIMD_X86 0
+#endif
+
+// GCC/Clang 需要为单个函数开启指令集，MSVC 可直接使用内建函数
+#if defined(__GNUC__) || defined(__clang__)
+    #define QTCSV_TARGET_SSE2 __attribute__((target("sse2")))
+    #define QTCSV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define QTCSV_TARGET_SSE2
+    #define QTCSV_TARGET_AVX2
+#endif
+
+namespace CsvSimd {
+
+namespace {
+
+inline unsigned countTrailingZeros(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+inline unsigned popCount(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+    mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned>((mask * 0x0101010101010101ULL) >> 56);
+#else
+    return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+}
+
+inline void appendBits(uint64_t mask, uint32_t base, std::vector<uint32_t>& positions) {
+    while (mask) {
+        positions.push_back(base + countTrailingZeros(mask));
+        mask &= mask - 1;
+    }
+}
+
+// ==================== 标量实现 ====================
+
+void structuralScalar(const char* begin, const char* end, char separator,
+                      std::vector<uint32_t>& positions) {
+    for (const char* p = begin; p < end; ++p) {
+        const char ch = *p;
+        if (ch == separator || ch == '"' || ch == '\n' || ch == '\r') {
+            positions.push_back(static_cast<uint32_t>(p - begin));
+        }
+    }
+}
+
+const char* quoteScalar(const char* begin, const char* end) {
+    const void* hit = std::memchr(begin, '"', static_cast<size_t>(end - begin));
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+size_t countQuotesScalar(const char* begin, const char* end) {
+    size_t count = 0;
+    for (const char* p = begin; p < end; ++p) {
+        count += (*p == '"');
+    }
+    return count;
+}
+
+bool asciiScalar(const char* begin, const char* end) {
+    const char* p = begin;
+    // 每次检查 8 字节的最高位
+    for (; p + 8 <= end; p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        if (word & 0x8080808080808080ULL) return false;
+    }
+    for (; p < end; ++p) {
+        if (static_cast<unsigned char>(*p) >= 0x80) return false;
+    }
+    return true;
+}
+
+bool hasStructuralScalar(const char* begin, const char* end, char separator) {
+    for (const char* p = begin; p < end; ++p) {
+        const char ch = *p;
+        if (ch == separator || ch == '"' || ch == '\n' || ch == '\r') return true;
+    }
+    return false;
+}
+
+size_t narrowAsciiScalar(const char16_t* src, size_t size, char* dst) {
+    size_t i = 0;
+    for (; i < size && src[i] < 0x80; ++i) {
+        dst[i] = static_cast<char>(src[i]);
+    }
+    return i;
+}
+
+// 非空位图中第 base / 64 个字，末尾不足 64 行时去掉越界的位
+inline uint64_t validWord(const uint64_t* validity, size_t base, size_t size) {
+    const uint64_t word = validity[base >> 6];
+    return size - base >= 64 ? word : word & ((uint64_t(1) << (size - base)) - 1);
+}
+
+inline Moments emptyMoments() {
+    Moments m;
+    m.min = std::numeric_limits<double>::infinity();
+    m.max = -std::numeric_limits<double>::infinity();
+    return m;
+}
+
+// 逐位累加 word 中置位的元素（不计 count）
+inline void momentsBits(const double* values, uint64_t word, size_t base, Moments& m) {
+    while (word) {
+        const double v = values[base + countTrailingZeros(word)];
+        m.sum += v;
+        m.min = v < m.min ? v : m.min;
+        m.max = v > m.max ? v : m.max;
+        word &= word - 1;
+    }
+}
+
+inline double deviationsBits(const double* values, uint64_t word, size_t base, double mean) {
+    double acc = 0;
+    while (word) {
+        const double d = values[base + countTrailingZeros(word)] - mean;
+        acc += d * d;
+        word &= word - 1;
+    }
+    return acc;
+}
+
+Moments momentsScalar(const double* values, const uint64_t* validity, size_t size) {
+    Moments m = emptyMoments();
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        m.count += popCount(word);
+        momentsBits(values, word, base, m);
+    }
+    return m;
+}
+
+double deviationsScalar(const double* values, const uint64_t* validity, size_t size, double mean) {
+    double acc = 0;
+    for (size_t base = 0; base < size; base += 64) {
+        acc += deviationsBits(values, validWord(validity, base, size), base, mean);
+    }
+    return acc;
+}
+
+inline uint64_t rangeBits(const double* values, size_t from, size_t to, size_t base, double low, double high) {
+    uint64_t bits = 0;
+    for (size_t i = from; i < to; ++i) {
+        if (values[i] >= low && values[i] <= high) bits |= uint64_t(1) << (i - base);
+    }
+    return bits;
+}
+
+void selectRangeScalar(const double* values, const uint64_t* validity, size_t size,
+                       double low, double high, uint64_t* out) {
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        out[base >> 6] = word ? rangeBits(values, base, std::min(base + 64, size), base, low, high) & word : 0;
+    }
+}
+
+#if QTCSV_SIMD_X86
+
+// ==================== SSE2 实现 ====================
+
+QTCSV_TARGET_SSE2 inline uint32_t structuralMask16(const char* p, __m128i sep, __m128i quote,
+                                                   __m128i cr, __m128i lf) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sep), _mm_cmpeq_epi8(v, quote)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(hit));
+}
+
+QTCSV_TARGET_SSE2 inline uint32_t quoteMask16(const char* p, __m128i quote) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)));
+}
+
+QTCSV_TARGET_SSE2 void structuralSse2(const char* begin, const char* end, char separator,
+                                      std::vector<uint32_t>& positions) {
+    const __m128i sep = _mm_set1_epi8(separator);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    const char* p = begin;
+    for (; p + 64 <= end; p += 64) {
+        const uint64_t mask = uint64_t(structuralMask16(p, sep, quote, cr, lf))
+                            | (uint64_t(structuralMask16(p + 16, sep, quote, cr, lf)) << 16)
+                            | (uint64_t(structuralMask16(p + 32, sep, quote, cr, lf)) << 32)
+                            | (uint64_t(structuralMask16(p + 48, sep, quote, cr, lf)) << 48);
+        appendBits(mask, static_cast<uint32_t>(p - begin), positions);
+    }
+
+    const size_t offset = positions.size();
+    structuralScalar(p, end, separator, positions);
+    for (size_t i = offset; i < positions.size(); ++i) {
+        positions[i] += static_cast<uint32_t>(p - begin);
+    }
+}
+
+QTCSV_TARGET_SSE2 const char* quoteSse2(const char* begin, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const char* p = begin;
+    for (; p + 16 <= end; p += 16) {
+        const uint32_t mask = quoteMask16(p, quote);
+        if (mask) return p + countTrailingZeros(mask);
+    }
+    return quoteScalar(p, end);
+}
+
+QTCSV_TARGET_SSE2 size_t countQuotesSse2(const char* begin, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    size_t count = 0;
+    const char* p = begin;
+    for (; p + 16 <= end; p += 16) {
+        count += popCount(quoteMask16(p, quote));
+    }
+    return count + countQuotesScalar(p, end);
+}
+
+QTCSV_TARGET_SSE2 bool asciiSse2(const char* begin, const char* end) {
+    const char* p = begin;
+    __m128i acc = _mm_setzero_si128();
+    for (; p + 16 <= end; p += 16) {
+        acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    return _mm_movemask_epi8(acc) == 0 && asciiScalar(p, end);
+}
+
+QTCSV_TARGET_SSE2 bool hasStructuralSse2(const char* begin, const char* end, char separator) {
+    const __m128i sep = _mm_set1_epi8(separator);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    const char* p = begin;
+    for (; p + 16 <= end; p += 16) {
+        if (structuralMask16(p, sep, quote, cr, lf)) return true;
+    }
+    return hasStructuralScalar(p, end, separator);
+}
+
+QTCSV_TARGET_SSE2 size_t narrowAsciiSse2(const char16_t* src, size_t size, char* dst) {
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        const __m128i high = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+    }
+    return i + narrowAsciiScalar(src + i, size - i, dst + i);
+}
+
+// 2 位掩码展开为 2 个 double 通道的全 1 / 全 0
+QTCSV_TARGET_SSE2 inline __m128d laneMask2(uint64_t bits) {
+    alignas(16) static const uint64_t masks[4][2] = {
+        { 0, 0 }, { ~uint64_t(0), 0 }, { 0, ~uint64_t(0) }, { ~uint64_t(0), ~uint64_t(0) }
+    };
+    return _mm_load_pd(reinterpret_cast<const double*>(masks[bits]));
+}
+
+QTCSV_TARGET_SSE2 Moments momentsSse2(const double* values, const uint64_t* validity, size_t size) {
+    const __m128d posInf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    const __m128d negInf = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+    __m128d sum = _mm_setzero_pd(), low = posInf, high = negInf;
+    Moments m = emptyMoments();     // 每个字末尾不足一组的元素
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        if (!word) continue;
+        m.count += popCount(word);
+        const size_t end = std::min(base + 64, size);
+        size_t i = base;
+        for (; i + 2 <= end; i += 2) {
+            const uint64_t bits = (word >> (i - base)) & 0x3;
+            if (!bits) continue;
+            const __m128d v = _mm_loadu_pd(values + i);
+            const __m128d mask = laneMask2(bits);
+            sum = _mm_add_pd(sum, _mm_and_pd(v, mask));
+            low = _mm_min_pd(_mm_or_pd(_mm_and_pd(mask, v), _mm_andnot_pd(mask, posInf)), low);
+            high = _mm_max_pd(_mm_or_pd(_mm_and_pd(mask, v), _mm_andnot_pd(mask, negInf)), high);
+        }
+        if (i < end) momentsBits(values, word >> (i - base) << (i - base), base, m);
+    }
+
+    alignas(16) double s[2], lo[2], hi[2];
+    _mm_store_pd(s, sum);
+    _mm_store_pd(lo, low);
+    _mm_store_pd(hi, high);
+    m.sum += s[0] + s[1];
+    for (int k = 0; k < 2; ++k) {
+        m.min = lo[k] < m.min ? lo[k] : m.min;
+        m.max = hi[k] > m.max ? hi[k] : m.max;
+    }
+    return m;
+}
+
+QTCSV_TARGET_SSE2 double deviationsSse2(const double* values, const uint64_t* validity, size_t size, double mean) {
+    const __m128d center = _mm_set1_pd(mean);
+    __m128d acc = _mm_setzero_pd();
+    double tail = 0;
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        if (!word) continue;
+        const size_t end = std::min(base + 64, size);
+        size_t i = base;
+        for (; i + 2 <= end; i += 2) {
+            const uint64_t bits = (word >> (i - base)) & 0x3;
+            if (!bits) continue;
+            const __m128d d = _mm_and_pd(_mm_sub_pd(_mm_loadu_pd(values + i), center), laneMask2(bits));
+            acc = _mm_add_pd(acc, _mm_mul_pd(d, d));
+        }
+        if (i < end) tail += deviationsBits(values, word >> (i - base) << (i - base), base, mean);
+    }
+
+    alignas(16) double s[2];
+    _mm_store_pd(s, acc);
+    return s[0] + s[1] + tail;
+}
+
+QTCSV_TARGET_SSE2 void selectRangeSse2(const double* values, const uint64_t* validity, size_t size,
+                                       double low, double high, uint64_t* out) {
+    const __m128d lo = _mm_set1_pd(low);
+    const __m128d hi = _mm_set1_pd(high);
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        if (!word) {
+            out[base >> 6] = 0;
+            continue;
+        }
+        const size_t end = std::min(base + 64, size);
+        uint64_t bits = 0;
+        size_t i = base;
+        for (; i + 2 <= end; i += 2) {
+            const __m128d v = _mm_loadu_pd(values + i);
+            const __m128d hit = _mm_and_pd(_mm_cmpge_pd(v, lo), _mm_cmple_pd(v, hi));
+            bits |= static_cast<uint64_t>(_mm_movemask_pd(hit)) << (i - base);
+        }
+        bits |= rangeBits(values, i, end, base, low, high);
+        out[base >> 6] = bits & word;
+    }
+}
+
+// ==================== AVX2 实现 ====================
+
+QTCSV_TARGET_AVX2 inline uint32_t structuralMask32(const char* p, __m256i sep, __m256i quote,
+                                                   __m256i cr, __m256i lf) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i hit = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, sep), _mm256_cmpeq_epi8(v, quote)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+}
+
+QTCSV_TARGET_AVX2 inline uint32_t quoteMask32(const char* p, __m256i quote) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)));
+}
+
+QTCSV_TARGET_AVX2 void structuralAvx2(const char* begin, const char* end, char separator,
+                                      std::vector<uint32_t>& positions) {
+    const __m256i sep = _mm256_set1_epi8(separator);
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    const char* p = begin;
+    for (; p + 64 <= end; p += 64) {
+        const uint64_t mask = uint64_t(structuralMask32(p, sep, quote, cr, lf))
+                            | (uint64_t(structuralMask32(p + 32, sep, quote, cr, lf)) << 32);
+        appendBits(mask, static_cast<uint32_t>(p - begin), positions);
+    }
+
+    const size_t offset = positions.size();
+    structuralScalar(p, end, separator, positions);
+    for (size_t i = offset; i < positions.size(); ++i) {
+        positions[i] += static_cast<uint32_t>(p - begin);
+    }
+}
+
+QTCSV_TARGET_AVX2 const char* quoteAvx2(const char* begin, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const char* p = begin;
+    for (; p + 32 <= end; p += 32) {
+        const uint32_t mask = quoteMask32(p, quote);
+        if (mask) return p + countTrailingZeros(mask);
+    }
+    return quoteScalar(p, end);
+}
+
+QTCSV_TARGET_AVX2 size_t countQuotesAvx2(const char* begin, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    size_t count = 0;
+    const char* p = begin;
+    for (; p + 64 <= end; p += 64) {
+        const uint64_t mask = uint64_t(quoteMask32(p, quote)) | (uint64_t(quoteMask32(p + 32, quote)) << 32);
+        count += popCount(mask);
+    }
+    return count + countQuotesScalar(p, end);
+}
+
+QTCSV_TARGET_AVX2 bool asciiAvx2(const char* begin, const char* end) {
+    const char* p = begin;
+    __m256i acc = _mm256_setzero_si256();
+    for (; p + 32 <= end; p += 32) {
+        acc = _mm256_or_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    }
+    return _mm256_movemask_epi8(acc) == 0 && asciiScalar(p, end);
+}
+
+QTCSV_TARGET_AVX2 bool hasStructuralAvx2(const char* begin, const char* end, char separator) {
+    const __m256i sep = _mm256_set1_epi8(separator);
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    const char* p = begin;
+    for (; p + 32 <= end; p += 32) {
+        if (structuralMask32(p, sep, quote, cr, lf)) return true;
+    }
+    return hasStructuralScalar(p, end, separator);
+}
+
+QTCSV_TARGET_AVX2 size_t narrowAsciiAvx2(const char16_t* src, size_t size, char* dst) {
+    const __m256i nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), nonAscii)) break;
+        // packus 按 128 位通道交错，需再按 64 位重排
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    return i + narrowAsciiScalar(src + i, size - i, dst + i);
+}
+
+// 4 位掩码展开为 4 个 double 通道的全 1 / 全 0
+QTCSV_TARGET_AVX2 inline __m256d laneMask4(uint64_t bits) {
+    const __m256i select = _mm256_setr_epi64x(1, 2, 4, 8);
+    const __m256i hit = _mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(bits)), select);
+    return _mm256_castsi256_pd(_mm256_cmpeq_epi64(hit, select));
+}
+
+QTCSV_TARGET_AVX2 Moments momentsAvx2(const double* values, const uint64_t* validity, size_t size) {
+    const __m256d posInf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    const __m256d negInf = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    __m256d low = posInf, high = negInf;
+    Moments m = emptyMoments();     // 每个字末尾不足一组的元素
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        if (!word) continue;
+        m.count += popCount(word);
+        const size_t end = std::min(base + 64, size);
+        size_t i = base;
+        if (word == ~uint64_t(0)) {
+            // 整字非空：不需要掩码，两路累加隐藏加法延迟
+            for (; i < end; i += 8) {
+                const __m256d a = _mm256_loadu_pd(values + i);
+                const __m256d b = _mm256_loadu_pd(values + i + 4);
+                sum0 = _mm256_add_pd(sum0, a);
+                sum1 = _mm256_add_pd(sum1, b);
+                low = _mm256_min_pd(_mm256_min_pd(a, b), low);
+                high = _mm256_max_pd(_mm256_max_pd(a, b), high);
+            }
+            continue;
+        }
+        for (; i + 4 <= end; i += 4) {
+            const uint64_t bits = (word >> (i - base)) & 0xF;
+            if (!bits) continue;
+            const __m256d v = _mm256_loadu_pd(values + i);
+            const __m256d mask = laneMask4(bits);
+            sum0 = _mm256_add_pd(sum0, _mm256_and_pd(v, mask));
+            low = _mm256_min_pd(_mm256_blendv_pd(posInf, v, mask), low);
+            high = _mm256_max_pd(_mm256_blendv_pd(negInf, v, mask), high);
+        }
+        if (i < end) momentsBits(values, word >> (i - base) << (i - base), base, m);
+    }
+
+    alignas(32) double s[4], lo[4], hi[4];
+    _mm256_store_pd(s, _mm256_add_pd(sum0, sum1));
+    _mm256_store_pd(lo, low);
+    _mm256_store_pd(hi, high);
+    m.sum += (s[0] + s[1]) + (s[2] + s[3]);
+    for (int k = 0; k < 4; ++k) {
+        m.min = lo[k] < m.min ? lo[k] : m.min;
+        m.max = hi[k] > m.max ? hi[k] : m.max;
+    }
+    return m;
+}
+
+QTCSV_TARGET_AVX2 double deviationsAvx2(const double* values, const uint64_t* validity, size_t size, double mean) {
+    const __m256d center = _mm256_set1_pd(mean);
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    double tail = 0;
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        if (!word) continue;
+        const size_t end = std::min(base + 64, size);
+        size_t i = base;
+        if (word == ~uint64_t(0)) {
+            for (; i < end; i += 8) {
+                const __m256d a = _mm256_sub_pd(_mm256_loadu_pd(values + i), center);
+                const __m256d b = _mm256_sub_pd(_mm256_loadu_pd(values + i + 4), center);
+                acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(a, a));
+                acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(b, b));
+            }
+            continue;
+        }
+        for (; i + 4 <= end; i += 4) {
+            const uint64_t bits = (word >> (i - base)) & 0xF;
+            if (!bits) continue;
+            const __m256d d = _mm256_and_pd(_mm256_sub_pd(_mm256_loadu_pd(values + i), center), laneMask4(bits));
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d, d));
+        }
+        if (i < end) tail += deviationsBits(values, word >> (i - base) << (i - base), base, mean);
+    }
+
+    alignas(32) double s[4];
+    _mm256_store_pd(s, _mm256_add_pd(acc0, acc1));
+    return (s[0] + s[1]) + (s[2] + s[3]) + tail;
+}
+
+QTCSV_TARGET_AVX2 void selectRangeAvx2(const double* values, const uint64_t* validity, size_t size,
+                                       double low, double high, uint64_t* out) {
+    const __m256d lo = _mm256_set1_pd(low);
+    const __m256d hi = _mm256_set1_pd(high);
+    for (size_t base = 0; base < size; base += 64) {
+        const uint64_t word = validWord(validity, base, size);
+        if (!word) {
+            out[base >> 6] = 0;
+            continue;
+        }
+        const size_t end = std::min(base + 64, size);
+        uint64_t bits = 0;
+        size_t i = base;
+        for (; i + 4 <= end; i += 4) {
+            const __m256d v = _mm256_loadu_pd(values + i);
+            const __m256d hit = _mm256_and_pd(_mm256_cmp_pd(v, lo, _CMP_GE_OQ), _mm256_cmp_pd(v, hi, _CMP_LE_OQ));
+            bits |= static_cast<uint64_t>(_mm256_movemask_pd(hit)) << (i - base);
+        }
+        bits |= rangeBits(values, i, end, base, low, high);
+        out[base >> 6] = bits & word;
+    }
+}
+
+bool cpuHasSse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;  // x86-64 基线指令集
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#endif
+}
+
+bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#endif
+}
+
+#endif // QTCSV_SIMD_X86
+
+// ==================== 运行时分派 ====================
+
+struct Kernels {
+    InstructionSet set;
+    void (*structural)(const char*, const char*, char, std::vector<uint32_t>&);
+    const char* (*quote)(const char*, const char*);
+    size_t (*countQuotes)(const char*, const char*);
+    bool (*ascii)(const char*, const char*);
+    bool (*hasStructural)(const char*, const char*, char);
+    size_t (*narrowAscii)(const char16_t*, size_t, char*);
+    Moments (*moments)(const double*, const uint64_t*, size_t);
+    double (*deviations)(const double*, const uint64_t*, size_t, double);
+    void (*selectRange)(const double*, const uint64_t*, size_t, double, double, uint64_t*);
+};
+
+const Kernels scalarKernels = { InstructionSet::Scalar, structuralScalar, quoteScalar, countQuotesScalar,
+                                asciiScalar, hasStructuralScalar, narrowAsciiScalar,
+                                momentsScalar, deviationsScalar, selectRangeScalar };
+#if QTCSV_SIMD_X86
+const Kernels sse2Kernels = { InstructionSet::SSE2, structuralSse2, quoteSse2, countQuotesSse2,
+                              asciiSse2, hasStructuralSse2, narrowAsciiSse2,
+                              momentsSse2, deviationsSse2, selectRangeSse2 };
+const Kernels avx2Kernels = { InstructionSet::AVX2, structuralAvx2, quoteAvx2, countQuotesAvx2,
+                              asciiAvx2, hasStructuralAvx2, narrowAsciiAvx2,
+                              momentsAvx2, deviationsAvx2, selectRangeAvx2 };
+#endif
+
+InstructionSet bestSupported(InstructionSet requested) {
+#if QTCSV_SIMD_X86
+    if (requested == InstructionSet::AVX2 && cpuHasAvx2()) return InstructionSet::AVX2;
+    if (requested != InstructionSet::Scalar && cpuHasSse2()) return InstructionSet::SSE2;
+#else
+    (void)requested;
+#endif
+    return InstructionSet::Scalar;
+}
+
+const Kernels* kernelsFor(InstructionSet set) {
+    switch (bestSupported(set)) {
+#if QTCSV_SIMD_X86
+        case InstructionSet::AVX2: return &avx2Kernels;
+        case InstructionSet::SSE2: return &sse2Kernels;
+#endif
+        default: return &scalarKernels;
+    }
+}
+
+const Kernels* detectKernels() {
+    InstructionSet requested = InstructionSet::AVX2;
+    if (const char* env = std::getenv("QTCSV_SIMD")) {
+        if (std::strcmp(env, "scalar") == 0) requested = InstructionSet::Scalar;
+        else if (std::strcmp(env, "sse2") == 0) requested = InstructionSet::SSE2;
+    }
+    return kernelsFor(requested);
+}
+
+std::atomic<const Kernels*> activeKernels{nullptr};
+
+inline const Kernels& kernels() {
+    const Kernels* k = activeKernels.load(std::memory_order_acquire);
+    if (!k) {
+        k = detectKernels();
+        activeKernels.store(k, std::memory_order_release);
+    }
+    return *k;
+}
+
+} // namespace
+
+InstructionSet activeInstructionSet() {
+    return kernels().set;
+}
+
+const char* instructionSetName(InstructionSet set) {
+    switch (set) {
+        case InstructionSet::AVX2: return "avx2";
+        case InstructionSet::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void setInstructionSet(InstructionSet set) {
+    activeKernels.store(kernelsFor(set), std::memory_order_release);
+}
+
+void findStructural(const char* begin, const char* end, char separator,
+                    std::vector<uint32_t>& positions) {
+    kernels().structural(begin, end, separator, positions);
+}
+
+const char* findQuote(const char* begin, const char* end) {
+    return kernels().quote(begin, end);
+}
+
+size_t countQuotes(const char* begin, const char* end) {
+    return kernels().countQuotes(begin, end);
+}
+
+bool isAscii(const char* begin, const char* end) {
+    return kernels().ascii(begin, end);
+}
+
+bool hasStructural(const char* begin, const char* end, char separator) {
+    return kernels().hasStructural(begin, end, separator);
+}
+
+size_t narrowAscii(const char16_t* src, size_t size, char* dst) {
+    return kernels().narrowAscii(src, size, dst);
+}
+
+Moments moments(const double* values, const uint64_t* validity, size_t size) {
+    return kernels().moments(values, validity, size);
+}
+
+double squaredDeviations(const double* values, const uint64_t* validity, size_t size, double mean) {
+    return kernels().deviations(values, validity, size, mean);
+}
+
+void selectRange(const double* values, const uint64_t* validity, size_t size,
+                 double low, double high, uint64_t* out) {
+    kernels().selectRange(values, validity, size, low, high, out);
+}
+
+} // namespace CsvSimd
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// SIMD 加速的 CSV 结构字符扫描与列统计、过滤
+// 按 64 字节块一次性比较分隔符、引号、CR、LF，运行时在 AVX2 / SSE2 / 标量实现之间分派。
+// 本头文件仅供库内部使用，不安装。
+
+namespace CsvSimd {
+    enum class InstructionSet {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // 当前使用的指令集（首次调用时检测 CPU，可用环境变量 QTCSV_SIMD=scalar|sse2|avx2 覆盖）
+    InstructionSet activeInstructionSet();
+    const char* instructionSetName(InstructionSet set);
+
+    // 强制指定指令集（测试和基准用），超出 CPU 能力时降级到可用的最高级别
+    void setInstructionSet(InstructionSet set);
+
+    // 将 [begin, end) 中所有结构字符（分隔符、引号、CR、LF）相对 begin 的偏移追加到 positions
+    // 区间长度不得超过 4GB
+    void findStructural(const char* begin, const char* end, char separator,
+                        std::vector<uint32_t>& positions);
+
+    // 返回第一个引号的位置，没有则返回 end
+    const char* findQuote(const char* begin, const char* end);
+
+    // 统计引号个数
+    size_t countQuotes(const char* begin, const char* end);
+
+    // 检查区间是否全部为 ASCII
+    bool isAscii(const char* begin, const char* end);
+
+    // 区间内是否含有结构字符（分隔符、引号、CR、LF），即写出时是否需要加引号
+    bool hasStructural(const char* begin, const char* end, char separator);
+
+    // 将 UTF-16 开头连续的 ASCII 字符逐个收窄写入 dst，返回处理的字符数
+    size_t narrowAscii(const char16_t* src, size_t size, char* dst);
+
+    // 列统计：values 与非空位图 validity（第 i 位对应 values[i]）中置位元素的个数、和、最值。
+    // count 为 0 时 min 为 +inf、max 为 -inf
+    struct Moments {
+        size_t count = 0;
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+    };
+    Moments moments(const double* values, const uint64_t* validity, size_t size);
+
+    // 置位元素与 mean 之差的平方和（方差的第二遍）
+    double squaredDeviations(const double* values, const uint64_t* validity, size_t size, double mean);
+
+    // 过滤：out 的第 i 位 = validity 第 i 位置位且 low <= values[i] <= high（NaN 不满足），
+    // out 须有 (size + 63) / 64 个字
+    void selectRange(const double* values, const uint64_t* validity, size_t size,
+                     double low, double high, uint64_t* out);
+}
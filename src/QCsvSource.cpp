@@ -0,0 +1,302 @@
+#include "QCsvSource.hpp"
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+namespace {
+
+// 提示内核按顺序预读
+void adviseSequential(QFile& file) {
+#ifdef Q_OS_LINUX
+    posix_fadvise(file.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+    Q_UNUSED(file);
+#endif
+}
+
+// ==================== 缓冲读取 ====================
+
+class BufferedSource : public CsvSource {
+public:
+    explicit BufferedSource(size_t blockSize) : buffer(blockSize) {}
+
+    bool open(const QString& path) override {
+        file.setFileName(path);
+        // 大块读取直接进入我们的缓冲区，不经 QIODevice 的内部缓冲
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+            lastError = file.errorString();
+            return false;
+        }
+        adviseSequential(file);
+        used = 0;
+        return true;
+    }
+
+    bool seek(quint64 offset) override {
+        used = 0;
+        lastError.clear();
+        if (!file.seek(static_cast<qint64>(offset))) {
+            lastError = file.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    void next(size_t keep, const char*& data, size_t& size) override {
+        // 保留的字节位于上一块末尾，移到缓冲区开头
+        if (keep > 0 && keep < used) {
+            std::memmove(buffer.data(), buffer.data() + used - keep, keep);
+        }
+        used = keep;
+        if (used > buffer.size() / 2) {
+            // 超长字段：扩容，避免每次只读入一小段又整体搬移
+            buffer.resize(buffer.size() * 2);
+        }
+
+        const qint64 read = file.read(buffer.data() + used, static_cast<qint64>(buffer.size() - used));
+        if (read < 0) {
+            lastError = file.errorString();
+        } else {
+            used += static_cast<size_t>(read);
+        }
+        data = buffer.data();
+        size = used;
+    }
+
+private:
+    QFile file;
+    std::vector<char> buffer;
+    size_t used = 0;
+};
+
+// ==================== 内存映射 ====================
+
+class MappedSource : public CsvSource {
+public:
+    explicit MappedSource(size_t blockSize) : blockSize(blockSize) {}
+
+    bool open(const QString& path) override {
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            lastError = file.errorString();
+            return false;
+        }
+        fileSize = static_cast<size_t>(file.size());
+        if (fileSize > 0) {
+            uchar* mapped = file.map(0, file.size());
+            if (!mapped) {
+                lastError = file.errorString();
+                file.close();
+                return false;
+            }
+#ifdef Q_OS_UNIX
+            madvise(mapped, fileSize, MADV_SEQUENTIAL);
+#endif
+            base = reinterpret_cast<const char*>(mapped);
+        }
+        pos = 0;
+        return true;
+    }
+
+    bool seek(quint64 offset) override {
+        pos = std::min(static_cast<size_t>(offset), fileSize);
+        return true;
+    }
+
+    void next(size_t keep, const char*& data, size_t& size) override {
+        // 映射是连续的，保留的字节就在新块之前，只需移动窗口
+        const size_t begin = pos - keep;
+        pos = std::min(pos + blockSize, fileSize);
+        data = base + begin;
+        size = pos - begin;
+    }
+
+private:
+    QFile file;                 // 映射随文件关闭一起释放
+    const char* base = nullptr;
+    size_t fileSize = 0;
+    size_t pos = 0;             // 已交给解析器的字节末尾
+    size_t blockSize;
+};
+
+// ==================== 后台预读（双缓冲） ====================
+
+// 读取线程把文件顺序读入两个缓冲区，解析器处理其中一个时另一个正在读入。
+// 每个缓冲区前留有与块同样大的空间，上一块剩余的字节复制到新块数据之前即可拼成连续数据，
+// 不必整体复制新块。
+class ReadAheadSource : public CsvSource {
+public:
+    explicit ReadAheadSource(size_t blockSize) : blockSize(blockSize) {
+        for (Slot& slot : buffers) {
+            slot.data.resize(blockSize * 2);
+        }
+    }
+
+    ~ReadAheadSource() override {
+        stop();
+    }
+
+    bool open(const QString& path) override {
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+            lastError = file.errorString();
+            return false;
+        }
+        adviseSequential(file);
+        start();
+        return true;
+    }
+
+    bool seek(quint64 offset) override {
+        stop();
+        lastError.clear();
+        if (!file.seek(static_cast<qint64>(offset))) {
+            lastError = file.errorString();
+            return false;
+        }
+        start();
+        return true;
+    }
+
+    void next(size_t keep, const char*& data, size_t& size) override {
+        if (exhausted) {
+            data = windowEnd - keep;
+            size = keep;
+            return;
+        }
+
+        const int index = current < 0 ? 0 : current ^ 1;
+        Slot& slot = buffers[index];
+        {
+            QMutexLocker locker(&mutex);
+            while (!slot.ready) {
+                cond.wait(&mutex);
+            }
+            if (slot.last) {
+                exhausted = true;
+                if (!readError.isEmpty()) lastError = readError;
+            }
+        }
+
+        // slot 已就绪，读取线程不会再碰它，可以不加锁访问
+        char* const fresh = slot.data.data() + blockSize;
+        if (keep <= blockSize) {
+            if (keep > 0) std::memmove(fresh - keep, windowEnd - keep, keep);
+            data = fresh - keep;
+        } else {
+            // 剩余字节超过预留空间（超长字段），拼接到单独的缓冲区
+            spill.resize(keep + slot.filled);
+            std::memcpy(spill.data(), windowEnd - keep, keep);
+            std::memcpy(spill.data() + keep, fresh, slot.filled);
+            overflow.swap(spill);
+            data = overflow.data();
+        }
+        size = keep + slot.filled;
+        windowEnd = data + size;
+
+        // 上一块已经用完，交还读取线程
+        if (current >= 0) {
+            QMutexLocker locker(&mutex);
+            buffers[current].ready = false;
+            cond.wakeAll();
+        }
+        current = index;
+    }
+
+private:
+    struct Slot {
+        std::vector<char> data;     // 前半为预留空间，后半为读入的数据
+        size_t filled = 0;
+        bool ready = false;         // 已读入、等待解析
+        bool last = false;          // 文件末尾（或读取出错）
+    };
+
+    QFile file;
+    size_t blockSize;
+    Slot buffers[2];
+    int current = -1;               // 解析器正在使用的缓冲区
+    const char* windowEnd = nullptr;
+    bool exhausted = false;
+    std::vector<char> overflow;
+    std::vector<char> spill;
+
+    QMutex mutex;
+    QWaitCondition cond;
+    std::unique_ptr<QThread> thread;
+    bool stopping = false;
+    QString readError;
+
+    void start() {
+        for (Slot& slot : buffers) {
+            slot.filled = 0;
+            slot.ready = false;
+            slot.last = false;
+        }
+        current = -1;
+        windowEnd = nullptr;
+        exhausted = false;
+        stopping = false;
+        readError.clear();
+        thread.reset(QThread::create([this] { produce(); }));
+        thread->start();
+    }
+
+    void stop() {
+        if (!thread) return;
+        {
+            QMutexLocker locker(&mutex);
+            stopping = true;
+            cond.wakeAll();
+        }
+        thread->wait();
+        thread.reset();
+    }
+
+    void produce() {
+        for (int index = 0; ; index ^= 1) {
+            Slot& slot = buffers[index];
+            {
+                QMutexLocker locker(&mutex);
+                while (slot.ready && !stopping) {
+                    cond.wait(&mutex);
+                }
+                if (stopping) return;
+            }
+
+            const qint64 read = file.read(slot.data.data() + blockSize, static_cast<qint64>(blockSize));
+
+            QMutexLocker locker(&mutex);
+            slot.filled = read > 0 ? static_cast<size_t>(read) : 0;
+            slot.last = read <= 0;
+            if (read < 0) readError = file.errorString();
+            slot.ready = true;
+            cond.wakeAll();
+            if (slot.last) return;
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<CsvSource> CsvSource::create(CsvReader::IoBackend backend, size_t blockSize) {
+    blockSize = std::max<size_t>(blockSize, 64);
+    switch (backend) {
+        case CsvReader::IoBackend::MemoryMap:
+            return std::make_unique<MappedSource>(blockSize);
+        case CsvReader::IoBackend::ReadAhead:
+            return std::make_unique<ReadAheadSource>(blockSize);
+        case CsvReader::IoBackend::Buffered:
+        default:
+            return std::make_unique<BufferedSource>(blockSize);
+    }
+}
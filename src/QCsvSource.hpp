@@ -0,0 +1,28 @@
+#pragma once
+#include "QCsv.hpp"
+#include <memory>
+
+// CsvReader 的数据来源
+// 各后端以连续数据块的形式顺序提供文件内容；上一块末尾尚未处理完的字节会出现在下一块开头，
+// 解析器只需扫描新读入的部分。本头文件仅供库内部使用，不安装。
+class CsvSource {
+public:
+    virtual ~CsvSource() = default;
+
+    static std::unique_ptr<CsvSource> create(CsvReader::IoBackend backend, size_t blockSize);
+
+    // 打开文件，失败时返回 false，原因见 errorString()
+    virtual bool open(const QString& path) = 0;
+    // 从文件的 offset 处重新开始提供数据
+    virtual bool seek(quint64 offset) = 0;
+
+    // 取下一块数据：返回的数据以上一块末尾的 keep 个字节开头，其后是新读入的字节。
+    // 到达文件末尾或出错时 size == keep，出错时 errorString() 非空。
+    // 上一块数据在本次调用后失效。
+    virtual void next(size_t keep, const char*& data, size_t& size) = 0;
+
+    QString errorString() const { return lastError; }
+
+protected:
+    QString lastError;
+};
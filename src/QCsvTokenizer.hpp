@@ -0,0 +1,119 @@
+#pragma once
+#include "QCsv.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CSV 分词器：在 CsvSimd::findStructural 找出的结构字符位置上运行引号状态机。
+// Utf8CsvParser（加载、懒加载行）、CsvParser 与 CsvReader（流式读取、过滤）共用这一份实现。
+// 方言与接收字段的 Sink 都是模板参数，常用分隔符各自实例化，热循环中的分隔符比较为编译期常量。
+// 本头文件仅供库内部使用，不安装。
+
+namespace CsvTokenizer {
+
+// 方言：引号固定为双引号（两个双引号转义），CR、LF、CRLF 均结束一行，
+// 与 findStructural 扫描的结构字符一致，因此方言只区分分隔符
+template<char Separator>
+struct Dialect {
+    static constexpr char separator = Separator;
+};
+
+using Comma = Dialect<','>;
+using Tab = Dialect<'\t'>;
+using Semicolon = Dialect<';'>;
+
+// 其余分隔符在运行时比较
+struct AnyDialect {
+    char separator;
+};
+
+// 按分隔符选择预先实例化的方言调用 func(dialect)
+template<typename Func>
+decltype(auto) withDialect(char separator, Func&& func) {
+    switch (separator) {
+        case ',': return func(Comma{});
+        case '\t': return func(Tab{});
+        case ';': return func(Semicolon{});
+        default: return func(AnyDialect{separator});
+    }
+}
+
+// 跨结构字符的位置状态。fieldStart 为当前字段尚未交给 Sink 的字节起点；
+// crNext 为紧跟行尾 CR 的位置，此处的 LF 不再结束一行
+struct Cursor {
+    const char* fieldStart = nullptr;
+    const char* crNext = nullptr;
+};
+
+// 依次处理 base + positions[i] 处的结构字符，返回处理的个数。Sink 需提供：
+//     void append(const char* begin, const char* end);  字段中引号前后、引号内的字节（含转义的引号）
+//     void quoted();                                     字段开始引号部分
+//     void field(const char* begin, const char* end);   字段结束，[begin, end) 为最后一段字节
+//     bool row(const char* next, bool cr);               行结束，next 为下一行起点；返回 true 时暂停
+//     void crlf(const char* next);                       CRLF 中的 LF，下一行实际从 next 开始
+// 暂停时 cursor 已指向下一行，再次调用时从返回值处继续
+template<typename D, typename Sink>
+size_t tokenize(const D& dialect, CsvQuoteState& state, Cursor& cursor, const char* base,
+                const quint32* positions, size_t count, Sink& sink) {
+    for (size_t i = 0; i < count; ) {
+        const char* p = base + positions[i++];
+        const char ch = *p;
+
+        if (state == CsvQuoteState::InQuotes) {
+            // 引号内只有引号有意义，分隔符和换行都是字段内容
+            if (ch == '"') {
+                sink.append(cursor.fieldStart, p);
+                cursor.fieldStart = p + 1;
+                state = CsvQuoteState::QuoteInQuotes;
+            }
+            continue;
+        }
+
+        if (state == CsvQuoteState::QuoteInQuotes) {
+            if (p == cursor.fieldStart && ch == '"') {
+                // 转义的双引号
+                sink.append(p, p + 1);
+                cursor.fieldStart = p + 1;
+                state = CsvQuoteState::InQuotes;
+                continue;
+            }
+            // 结束引号后跟普通字符或结构字符，均按普通状态处理
+            state = CsvQuoteState::Normal;
+        }
+
+        if (ch == '"') {
+            sink.append(cursor.fieldStart, p);
+            sink.quoted();
+            state = CsvQuoteState::InQuotes;
+        } else if (ch == dialect.separator) {
+            sink.field(cursor.fieldStart, p);
+        } else if (ch == '\n' && p == cursor.crNext) {
+            sink.crlf(p + 1);
+        } else {
+            sink.field(cursor.fieldStart, p);
+            cursor.fieldStart = p + 1;
+            if (ch == '\r') cursor.crNext = p + 1;
+            if (sink.row(p + 1, ch == '\r')) return i;
+            continue;
+        }
+        cursor.fieldStart = p + 1;
+    }
+    return count;
+}
+
+// 推送式解析一个窗口 [begin, end)，structural 为窗口内的结构字符偏移。
+// 窗口末尾未结束的字段字节交给 sink.append，pendingCR 记录窗口是否以行尾的 CR 结束
+template<typename D, typename Sink>
+void tokenizeWindow(const D& dialect, CsvQuoteState& state, bool& pendingCR, const char* begin, const char* end,
+                    const std::vector<quint32>& structural, Sink& sink) {
+    Cursor cursor{begin, pendingCR ? begin : nullptr};
+    tokenize(dialect, state, cursor, begin, structural.data(), structural.size(), sink);
+
+    if (state == CsvQuoteState::QuoteInQuotes && cursor.fieldStart != end) {
+        state = CsvQuoteState::Normal;
+    }
+    sink.append(cursor.fieldStart, end);
+    pendingCR = (cursor.crNext == end);
+}
+
+} // namespace CsvTokenizer
@@ -0,0 +1,134 @@
+#include "QCsvWriter.hpp"
+#include "QCsvSimd.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 编码一个非 ASCII 码点，返回消耗的 UTF-16 单元数；孤立代理项写为 U+FFFD
+qsizetype encodeCodePoint(const char16_t* src, const char16_t* end, char*& out) {
+    char32_t u = *src;
+    qsizetype consumed = 1;
+
+    if (u < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (u >> 6));
+        *out++ = static_cast<char>(0x80 | (u & 0x3F));
+        return consumed;
+    }
+
+    if (u >= 0xD800 && u <= 0xDBFF && src + 1 < end && src[1] >= 0xDC00 && src[1] <= 0xDFFF) {
+        u = 0x10000 + ((u - 0xD800) << 10) + (src[1] - 0xDC00);
+        *out++ = static_cast<char>(0xF0 | (u >> 18));
+        *out++ = static_cast<char>(0x80 | ((u >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (u & 0x3F));
+        return 2;
+    }
+
+    if (u >= 0xD800 && u <= 0xDFFF) {
+        u = 0xFFFD;
+    }
+    *out++ = static_cast<char>(0xE0 | (u >> 12));
+    *out++ = static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (u & 0x3F));
+    return consumed;
+}
+
+} // namespace
+
+CsvWriter::CsvWriter(QIODevice& device, char separator, qsizetype bufferSize)
+    : device(device), separator(separator), buffer(static_cast<size_t>(std::max<qsizetype>(bufferSize, 64))) {}
+
+void CsvWriter::reserve(qsizetype size) {
+    if (used + size <= static_cast<qsizetype>(buffer.size())) return;
+    flush();
+    if (size > static_cast<qsizetype>(buffer.size())) {
+        buffer.resize(static_cast<size_t>(size));
+    }
+}
+
+void CsvWriter::writeField(QStringView value) {
+    if (value.isEmpty()) return;
+
+    // 最坏情况：每个 UTF-16 单元 3 字节，另加两侧引号
+    const qsizetype worst = value.size() * 3 + 2;
+    reserve(worst);
+
+    char* const start = buffer.data() + used + 1;  // 预留开头引号的位置
+    char* out = start;
+    const char16_t* src = value.utf16();
+    const char16_t* const end = src + value.size();
+    while (src < end) {
+        const size_t ascii = CsvSimd::narrowAscii(src, static_cast<size_t>(end - src), out);
+        src += ascii;
+        out += ascii;
+        while (src < end && *src >= 0x80) {
+            src += encodeCodePoint(src, end, out);
+        }
+    }
+    finishField(out - start);
+}
+
+void CsvWriter::writeUtf8Field(const char* data, qsizetype size) {
+    if (size == 0) return;
+
+    // 最坏情况：每个字节都是引号，另加两侧引号
+    reserve(size * 2 + 2);
+    char* const start = buffer.data() + used + 1;
+    std::memcpy(start, data, static_cast<size_t>(size));
+    finishField(size);
+}
+
+void CsvWriter::finishField(qsizetype size) {
+    char* const start = buffer.data() + used + 1;
+    char* const out = start + size;
+    if (!CsvSimd::hasStructural(start, out, separator)) {
+        std::memmove(start - 1, start, static_cast<size_t>(size));
+        used += size;
+        return;
+    }
+
+    // 需要引号：从后向前把内部引号加倍。引号只占 1 字节，size + quotes 不超过调用方预留的
+    // 最坏情况（3 倍字符数或 2 倍字节数）
+    const qsizetype quotes = static_cast<qsizetype>(CsvSimd::countQuotes(start, out));
+    char* base = buffer.data() + used;
+    char* src8 = base + 1 + size;
+    char* dst8 = base + 1 + size + quotes;
+    *dst8 = '"';
+    while (src8 > base + 1) {
+        const char ch = *--src8;
+        *--dst8 = ch;
+        if (ch == '"') *--dst8 = '"';
+    }
+    *base = '"';
+    used += size + quotes + 2;
+}
+
+void CsvWriter::writeRaw(const char* data, qsizetype size) {
+    if (size >= static_cast<qsizetype>(buffer.size())) {
+        // 大块数据直接写入设备，不经缓冲区
+        flush();
+        if (!failed) {
+            const qint64 result = device.write(data, size);
+            if (result != size) failed = true;
+            else written += size;
+        }
+        return;
+    }
+    reserve(size);
+    std::memcpy(buffer.data() + used, data, static_cast<size_t>(size));
+    used += size;
+}
+
+bool CsvWriter::flush() {
+    if (used > 0 && !failed) {
+        const qint64 result = device.write(buffer.data(), used);
+        if (result != used) {
+            failed = true;
+        } else {
+            written += used;
+        }
+    }
+    used = 0;
+    return !failed;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <QIODevice>
+#include <QStringView>
+#include <vector>
+
+// 缓冲的 UTF-8 CSV 写入器
+// 字段直接编码进大块输出缓冲区，缓冲区满时才写入设备；是否需要引号由 SIMD 一次扫描判定。
+// 本头文件仅供库内部使用，不安装。
+class CsvWriter {
+public:
+    static constexpr qsizetype DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    CsvWriter(QIODevice& device, char separator, qsizetype bufferSize = DEFAULT_BUFFER_SIZE);
+
+    // 写入一个字段，含分隔符、引号或换行时加引号并转义
+    void writeField(QStringView value);
+    // 同 writeField，字段已是 UTF-8，不再编码
+    void writeUtf8Field(const char* data, qsizetype size);
+    void writeSeparator() { put(separator); }
+    void endRow() { put('\n'); }
+
+    // 原样写入已编码的字节
+    void writeRaw(const char* data, qsizetype size);
+
+    // 将缓冲区写入设备，任一次写入失败后返回 false
+    bool flush();
+    bool hasError() const { return failed; }
+    qint64 bytesWritten() const { return written + used; }
+
+private:
+    QIODevice& device;
+    char separator;
+    std::vector<char> buffer;
+    qsizetype used = 0;
+    qint64 written = 0;
+    bool failed = false;
+
+    void reserve(qsizetype size);
+    // 缓冲区 used + 1 起的 size 字节为编码后的字段，按需加引号并转义
+    void finishField(qsizetype size);
+    void put(char ch) {
+        if (used == static_cast<qsizetype>(buffer.size())) reserve(1);
+        buffer[used++] = ch;
+    }
+};
@@ -2,9 +2,20 @@
 #include <QtTest/QTest>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QTemporaryFile>
 #include <QDateTime>
 #include <QSet>
+#include <QLocale>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include "QCsv.hpp"
 
 class QCsvTest : public QObject {
@@ -561,6 +572,1216 @@ private slots:
         QVERIFY(!csv.isBoolean(ageValue));
     }
 
+    // ==================== 测试列式存储 ====================
+    void testColumnarStorage() {
+        QString filePath = createTestCsvFile();
+        QCsv csv(filePath);
+        csv.load();
+
+        qDebug() << "测试整数行列访问...";
+        QCOMPARE(csv.getValue(1, 1), QString("Name"));
+        QCOMPARE(csv.getValue(2, 1), csv.getValue("A2"));
+        QCOMPARE(csv.getValue(4, 3), QString("Chicago"));
+        QCOMPARE(csv.getValue(10, 10), QString());
+        QCOMPARE(csv.size(), 12);
+        QVERIFY(csv.contains("c4"));  // 列字母不区分大小写
+        QVERIFY(!csv.contains("D1"));
+
+        // 非法键读取为空，写入抛出异常
+        QCOMPARE(csv.getValue("1A"), QString());
+        try {
+            csv.setValue("A0", "Invalid");
+            QFAIL("Expected std::invalid_argument not thrown");
+        } catch (const std::invalid_argument& e) {
+            QVERIFY(e.what());
+        }
+
+        qDebug() << "测试覆盖写入与删除...";
+        for (int i = 0; i < 10000; ++i) {
+            csv.setValue(2, 2, QString::number(i % 2 ? i : i * 1000));
+        }
+        QCOMPARE(csv.getValue("B2"), QString::number(9999));
+        csv.setValue(5000, 2, "far away");
+        QCOMPARE(csv.getRowCount(), 5000);
+        QCOMPARE(csv.getValue("B5000"), QString("far away"));
+        csv.setValue("B5000", "");
+        QVERIFY(!csv.contains("B5000"));
+        QCOMPARE(csv.size(), 12);
+        QCOMPARE(csv.getAllValues().size(), 12);
+        QCOMPARE(csv.keys().size(), 12);
+
+        qDebug() << "测试特殊字符往返...";
+        csv.setValue(2, 3, "a,b \"quoted\"\n多行");
+        QVERIFY(csv.saveAs("qtcsv_storage_test.csv"));
+
+        QCsv reloaded("qtcsv_storage_test.csv");
+        reloaded.load();
+        QCOMPARE(reloaded.getValue("C2"), QString("a,b \"quoted\"\n多行"));
+        QCOMPARE(reloaded.getValue(4, 1), QString("Charlie"));
+        QCOMPARE(reloaded.search("Charlie"), QList<QString>{"A4"});
+        QFile::remove("qtcsv_storage_test.csv");
+    }
+
+    // ==================== 测试 SIMD 解析器 ====================
+    void testSimdParser() {
+        // 超过 1MB 读取块，字段会跨块；同时覆盖 CRLF、转义引号、引号内换行和多字节字符
+        const int rows = 50000;
+        QFile file("qtcsv_simd_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 0; i < rows; ++i) {
+            QByteArray line = QByteArray::number(i) + ",\"quoted, \"\"x\"\" " + QByteArray::number(i)
+                            + "\nline2\",中文" + QByteArray::number(i) + ",plain\r\n";
+            file.write(line);
+        }
+        file.close();
+
+        QCsv csv("qtcsv_simd_test.csv");
+        csv.load();
+        QCOMPARE(csv.getRowCount(), rows);
+        QCOMPARE(csv.getColumnCount(), 4);
+        QCOMPARE(csv.size(), rows * 4);
+
+        for (int i : {0, 1, 9999, 21846, 43690, rows - 1}) {
+            QCOMPARE(csv.getValue(i + 1, 1), QString::number(i));
+            QCOMPARE(csv.getValue(i + 1, 2), QString("quoted, \"x\" %1\nline2").arg(i));
+            QCOMPARE(csv.getValue(i + 1, 3), QString("中文%1").arg(i));
+            QCOMPARE(csv.getValue(i + 1, 4), QString("plain"));
+        }
+        QFile::remove("qtcsv_simd_test.csv");
+    }
+
+    // ==================== 测试分隔符方言 ====================
+    void testDialects() {
+        // 预先实例化的逗号、制表符、分号，以及运行时比较的其它分隔符
+        for (char sep : { ',', '\t', ';', '|' }) {
+            const QByteArray s(1, sep);
+            QByteArray note = ",\t;|";   // 其它方言的分隔符在这里是普通字符
+            note.replace(sep, "");
+            QFile file("qtcsv_dialect_test.csv");
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("id" + s + "text" + s + "note\r\n");
+            file.write("1" + s + "\"a" + s + "b\"" + s + note + "\r\n");
+            file.write("2" + s + "\"say \"\"hi\"\"\nnext\"" + s + "\n");
+            file.write("3" + s + "中文" + s + "end");
+            file.close();
+
+            QCsv csv("qtcsv_dialect_test.csv");
+            csv.setSeparator(sep);
+            csv.load();
+            QCOMPARE(csv.getRowCount(), 4);
+            QCOMPARE(csv.getColumnCount(), 3);
+            QCOMPARE(csv.getValue(2, 2), QString("a" + s + "b"));
+            QCOMPARE(csv.getValue(2, 3), QString(note));
+            QCOMPARE(csv.getValue(3, 2), QString("say \"hi\"\nnext"));
+            QVERIFY(csv.getValue(3, 3).isEmpty());
+            QCOMPARE(csv.getValue(4, 2), QString("中文"));
+
+            CsvReader reader("qtcsv_dialect_test.csv", sep);
+            QStringList seen;
+            for (const CsvReader::Row& row : reader) {
+                seen.append(row[1].toString());
+            }
+            QCOMPARE(seen, QStringList({"text", "a" + QString(s) + "b", "say \"hi\"\nnext", "中文"}));
+        }
+        QFile::remove("qtcsv_dialect_test.csv");
+    }
+
+    // ==================== 测试并行加载 ====================
+    void testParallelLoad() {
+        // 随机拼接各种难点片段，使引号内换行、转义引号、CRLF 等随机落在分块边界上
+        const QByteArray pieces[] = {
+            "abc", "12", "中文", ",", ",", "\n", "\r\n", "\r", "\"\"",
+            "\"q,\"\"x\"\"\n\"", "\"a\r\nb\"", "\"\n\n\"", "\"x\"\"\"", ""
+        };
+        QRandomGenerator rng(20240601);
+        QByteArray content;
+        while (content.size() < 3 * 1024 * 1024) {
+            content += pieces[rng.bounded(int(std::size(pieces)))];
+        }
+        content += "tail,\"no newline";
+
+        QFile file("qtcsv_parallel_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(content);
+        file.close();
+
+        QCsv serial("qtcsv_parallel_test.csv");
+        serial.load();
+
+        for (int threads : {1, 3, 8}) {
+            QCsv parallel("qtcsv_parallel_test.csv");
+            QCsv::LoadOptions options;
+            options.parallel = true;
+            options.threadCount = threads;
+            options.parallelThreshold = 0;
+            parallel.setLoadOptions(options);
+            parallel.load();
+
+            QCOMPARE(parallel.getRowCount(), serial.getRowCount());
+            QCOMPARE(parallel.getColumnCount(), serial.getColumnCount());
+            QCOMPARE(parallel.size(), serial.size());
+            QCOMPARE(parallel.getAllValues(), serial.getAllValues());
+            const QList<QString> expected = serial.search("中文");
+            const QList<QString> actual = parallel.search("中文");
+            QCOMPARE(QSet<QString>(actual.begin(), actual.end()), QSet<QString>(expected.begin(), expected.end()));
+        }
+        QFile::remove("qtcsv_parallel_test.csv");
+    }
+
+    // ==================== 测试内存映射加载 ====================
+    void testMemoryMappedLoad() {
+        QFile file("qtcsv_mmap_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 0; i < 20000; ++i) {
+            file.write(QByteArray::number(i) + ",名字" + QByteArray::number(i)
+                       + ",\"a,\"\"b\"\"\",plain\n");
+        }
+        file.close();
+
+        QCsv serial("qtcsv_mmap_test.csv");
+        serial.load();
+
+        QCsv mapped("qtcsv_mmap_test.csv");
+        QCsv::LoadOptions options;
+        options.memoryMap = true;
+        options.deferDecode = true;
+        mapped.setLoadOptions(options);
+        mapped.load();
+
+        QCOMPARE(mapped.getRowCount(), serial.getRowCount());
+        QCOMPARE(mapped.getColumnCount(), serial.getColumnCount());
+        // 默认选项（buildSearchIndex）下加载也不解码：未读取的块仍是映射中的 UTF-8 字节
+        QVERIFY(mapped.getValueView(20000, 4)->isUtf8());
+        QCOMPARE(mapped.getValue(12345, 2), QString("名字12344"));
+        QCOMPARE(mapped.getValue(12345, 3), QString("a,\"b\""));
+        QCOMPARE(mapped.search("名字7"), QList<QString>{"B8"});
+        QCOMPARE(mapped.getAllValues(), serial.getAllValues());
+
+        // 覆盖保存正被映射的源文件
+        mapped.setValue(1, 1, "changed");
+        QVERIFY(mapped.save());
+        mapped.load();
+        QCOMPARE(mapped.getValue(1, 1), QString("changed"));
+        QCOMPARE(mapped.getValue(20000, 4), QString("plain"));
+        QFile::remove("qtcsv_mmap_test.csv");
+    }
+
+    // ==================== 测试懒加载 ====================
+    void testLazyLoad() {
+        QFile file("qtcsv_lazy_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 0; i < 10000; ++i) {
+            file.write(QByteArray::number(i) + ",\"多行\r\n" + QByteArray::number(i) + "\",,x\r\n");
+        }
+        file.close();
+
+        QCsv eager("qtcsv_lazy_test.csv");
+        eager.load();
+
+        QCsv csv("qtcsv_lazy_test.csv");
+        QCsv::LoadOptions options;
+        options.lazy = true;
+        options.rowCacheSize = 16;
+        csv.setLoadOptions(options);
+        csv.load();
+
+        QCOMPARE(csv.getRowCount(), eager.getRowCount());
+        QCOMPARE(csv.getColumnCount(), eager.getColumnCount());
+        QCOMPARE(csv.size(), eager.size());
+        QCOMPARE(csv.getValue("B5000"), QString("多行\r\n4999"));
+        QCOMPARE(csv.getValue(10000, 4), QString("x"));
+        QVERIFY(!csv.contains("C1"));
+        QCOMPARE(csv.search("4321"), QList<QString>{"A4322"});
+
+        // 修改后该行转入内存，其余行仍按需解析
+        csv.setValue("C3", "filled");
+        csv.setValue("A3", "");
+        QCOMPARE(csv.getValue("C3"), QString("filled"));
+        QCOMPARE(csv.getValue("A3"), QString());
+        QCOMPARE(csv.getValue("B3"), QString("多行\r\n2"));
+        QCOMPARE(csv.size(), eager.size());
+        QCOMPARE(csv.getValueView(3, 3)->toString(), QString("filled"));
+        QVERIFY(!csv.getValueView(5000, 2).has_value());  // 尚未载入的行没有视图，与空单元格区分
+
+        eager.setValue("C3", "filled");
+        eager.setValue("A3", "");
+        QCOMPARE(csv.getAllValues(), eager.getAllValues());
+
+        // 覆盖保存源文件
+        QVERIFY(csv.save());
+        QCOMPARE(csv.getValue("B9"), QString("多行\r\n8"));
+        QCsv reloaded("qtcsv_lazy_test.csv");
+        reloaded.load();
+        QCOMPARE(reloaded.getAllValues(), eager.getAllValues());
+        QFile::remove("qtcsv_lazy_test.csv");
+    }
+
+    // ==================== 测试搜索索引类型 ====================
+    void testSearchIndexKinds() {
+        QString filePath = createTestCsvFile();
+        const QList<QCsv::SearchIndexKind> kinds = {
+            QCsv::SearchIndexKind::Ordered, QCsv::SearchIndexKind::Hash, QCsv::SearchIndexKind::Sorted
+        };
+
+        for (QCsv::SearchIndexKind kind : kinds) {
+            for (bool eager : {true, false}) {
+                QCsv csv(filePath);
+                QCsv::LoadOptions options;
+                options.buildSearchIndex = eager;
+                options.searchIndexKind = kind;
+                csv.setLoadOptions(options);
+                csv.load();
+
+                QCOMPARE(csv.search("Alice"), QList<QString>{"A2"});
+                QList<QString> prefix = csv.searchByPrefix("Los");
+                QCOMPARE(prefix, QList<QString>{"C3"});
+
+                // 修改后索引保持一致
+                csv.setValue("C4", "Los Altos");
+                csv.setValue("A2", "");
+                QVERIFY(csv.search("Alice").isEmpty());
+                prefix = csv.searchByPrefix("Los");
+                std::sort(prefix.begin(), prefix.end());
+                QCOMPARE(prefix, (QList<QString>{"C3", "C4"}));
+                QCOMPARE(csv.searchColumnHeader("City"), QList<int>{3});
+                QCOMPARE(csv.searchRowHeader("Bob"), QList<int>{3});
+            }
+        }
+        QFile::remove(filePath);
+    }
+
+    // ==================== 测试缓冲写入 ====================
+    void testBufferedWriter() {
+        QCsv csv("qtcsv_writer_test.csv");
+        csv.setValue(1, 1, "a,b");
+        csv.setValue(1, 3, "say \"hi\"");
+        csv.setValue(2, 2, QString::fromUtf8("多行\n文本😀"));
+        csv.setValue(3, 1, "plain");
+        QVERIFY(csv.saveAs("qtcsv_writer_test.csv"));
+
+        QFile file("qtcsv_writer_test.csv");
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        QCOMPARE(file.readAll(),
+                 QString::fromUtf8("\"a,b\",,\"say \"\"hi\"\"\"\n,\"多行\n文本😀\",\nplain,,\n").toUtf8());
+        file.close();
+
+        // 超过缓冲区大小的数据往返一致
+        QCsv large("qtcsv_writer_test.csv");
+        for (int row = 1; row <= 30000; ++row) {
+            large.setValue(row, 1, QString::number(row));
+            large.setValue(row, 3, QString::fromUtf8("值,\"") + QString::number(row) + "\"");
+        }
+        QVERIFY(large.saveAs("qtcsv_writer_test.csv"));
+        QCsv reloaded("qtcsv_writer_test.csv");
+        reloaded.load();
+        QCOMPARE(reloaded.getRowCount(), 30000);
+        QCOMPARE(reloaded.getAllValues(), large.getAllValues());
+        QFile::remove("qtcsv_writer_test.csv");
+    }
+
+    // ==================== 测试并发访问 ====================
+    void testConcurrentAccess() {
+        QCsv csv("qtcsv_concurrent_test.csv");
+        csv.setConcurrent(true);
+        QVERIFY(csv.isConcurrent());
+        csv.setValue(20000, 4, "end");
+
+        std::atomic<int> mismatches{0};
+        std::atomic<bool> saved{true};
+        QList<QThread*> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.append(QThread::create([&csv, t]() {
+                for (int row = t + 1; row <= 20000; row += 4) {
+                    csv.setValue(row, 1, QString::number(row));
+                    csv.setValue(row, 2 + t % 2, "w" + QString::number(t));
+                }
+            }));
+        }
+        for (int t = 0; t < 2; ++t) {
+            threads.append(QThread::create([&csv, &mismatches]() {
+                for (int row = 1; row <= 20000; ++row) {
+                    const QString value = csv.getValue(row, 1);
+                    if (!value.isEmpty() && value != QString::number(row)) ++mismatches;
+                }
+            }));
+        }
+        threads.append(QThread::create([&csv, &saved]() {
+            for (int i = 0; i < 3; ++i) {
+                if (!csv.save()) saved = false;
+            }
+        }));
+        for (QThread* thread : threads) thread->start();
+        for (QThread* thread : threads) {
+            thread->wait();
+            delete thread;
+        }
+
+        QCOMPARE(mismatches.load(), 0);
+        QVERIFY(saved.load());
+        QCOMPARE(csv.size(), 40001);
+        QCOMPARE(csv.search("w1").size(), 5000);
+        QCOMPARE(csv.getValue(19999, 4), QString());
+
+        QVERIFY(csv.save());
+        QCsv reloaded("qtcsv_concurrent_test.csv");
+        reloaded.setConcurrent(true);
+        reloaded.load();
+        QCOMPARE(reloaded.getAllValues(), csv.getAllValues());
+        QFile::remove("qtcsv_concurrent_test.csv");
+    }
+
+    // ==================== 测试快照 ====================
+    void testSnapshot() {
+        QFile file("qtcsv_snapshot_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 1; i <= 10000; ++i) {
+            file.write("r" + QByteArray::number(i) + ",v\n");
+        }
+        file.close();
+
+        QCsv csv("qtcsv_snapshot_test.csv");
+        QCsv::LoadOptions options;
+        options.memoryMap = true;
+        options.deferDecode = true;
+        csv.setLoadOptions(options);
+        csv.load();
+
+        QCsv::Snapshot snapshot = csv.snapshot();
+        csv.setValue(1, 1, "changed");
+        csv.setValue(10001, 1, "appended");
+        QCOMPARE(snapshot.getValue(1, 1), QString("r1"));
+        QCOMPARE(snapshot.getValue("A10001"), QString());
+        QCOMPARE(snapshot.getRowCount(), 10000);
+        QCOMPARE(snapshot.size(), 20000);
+        QCOMPARE(csv.getValue(1, 1), QString("changed"));
+
+        // 后台写出的是调用 sync() 时的数据，期间的修改不影响结果
+        const QCsv::Snapshot expected = csv.snapshot();
+        QFuture<bool> future = csv.sync();
+        for (int row = 1; row <= 10000; row += 7) {
+            csv.setValue(row, 2, "after");
+        }
+        QVERIFY(future.result());
+
+        QCsv reloaded("qtcsv_snapshot_test.csv");
+        reloaded.load();
+        QCOMPARE(reloaded.getRowCount(), expected.getRowCount());
+        QCOMPARE(reloaded.size(), expected.size());
+        QCOMPARE(reloaded.getValue(1, 1), QString("changed"));
+        QCOMPARE(reloaded.getValue(8, 2), QString("v"));
+        QCOMPARE(reloaded.getValue(10001, 1), QString("appended"));
+
+        // 写出期间关闭指标并销毁对象：后台线程持有自己的指标状态，析构等待写出结束
+        QFuture<bool> detached;
+        {
+            QCsv owner("qtcsv_snapshot_test.csv");
+            owner.setMetricsEnabled(true);
+            owner.load();
+            owner.setValue(2, 1, "detached");
+            detached = owner.sync();
+            owner.setMetricsEnabled(false);
+        }
+        QVERIFY(detached.isFinished());
+        QVERIFY(detached.result());
+        reloaded.load();
+        QCOMPARE(reloaded.getValue(2, 1), QString("detached"));
+        QFile::remove("qtcsv_snapshot_test.csv");
+    }
+
+    // ==================== 测试增量保存 ====================
+    void testIncrementalSave() {
+        QFile file("qtcsv_incremental_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("id,name\r\n1,\"a,b\"\r\n2,bob\r\n3,carol\r\n");
+        file.close();
+
+        QCsv csv("qtcsv_incremental_test.csv");
+        QCsv::LoadOptions options;
+        options.trackChanges = true;
+        csv.setLoadOptions(options);
+        csv.load();
+
+        // 只重写被修改的行，其余行（包括 CRLF 和引号写法）原样保留，改写和新增的行沿用 CRLF
+        csv.setValue(3, 2, "robert");
+        csv.setValue(5, 1, "4");
+        QVERIFY(csv.atomicSave());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), QByteArray("id,name\r\n1,\"a,b\"\r\n2,robert\r\n3,carol\r\n4,\r\n"));
+        file.close();
+
+        // 保存后行偏移指向新文件，可以继续增量保存
+        csv.setValue(2, 2, "x\"y");
+        QVERIFY(csv.save());
+        QCsv reloaded("qtcsv_incremental_test.csv");
+        reloaded.load();
+        QCOMPARE(reloaded.getRowCount(), 5);
+        QCOMPARE(reloaded.getValue(2, 2), QString("x\"y"));
+        QCOMPARE(reloaded.getValue(3, 2), QString("robert"));
+        QCOMPARE(reloaded.getValue(5, 1), QString("4"));
+        QCOMPARE(reloaded.getAllValues(), csv.getAllValues());
+        QFile::remove("qtcsv_incremental_test.csv");
+    }
+
+    // ==================== 测试追加写入 ====================
+    void testAppender() {
+        QFile file("qtcsv_append_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("time,message");  // 没有结尾换行
+        file.close();
+
+        {
+            QCsvAppender appender("qtcsv_append_test.csv");
+            QVERIFY(appender.appendRow(std::vector<QString>{"1", "started"}));
+            QVERIFY(appender.appendRow(QStringList{"2", "a,b \"quoted\""}));
+            QCOMPARE(appender.rowsAppended(), 2);
+        }
+
+        QCsvAppender::Options options;
+        options.groupCommitRows = 100;
+        QCsvAppender appender("qtcsv_append_test.csv", options);
+        QVERIFY(appender.open());
+        QList<QStringList> rows;
+        for (int i = 3; i <= 1000; ++i) {
+            rows.append(QStringList{QString::number(i), QString::fromUtf8("行\n%1").arg(i)});
+        }
+        QVERIFY(appender.appendRows(rows));
+        appender.close();
+
+        QCsv csv("qtcsv_append_test.csv");
+        csv.load();
+        QCOMPARE(csv.getRowCount(), 1001);
+        QCOMPARE(csv.getValue(1, 2), QString("message"));
+        QCOMPARE(csv.getValue(2, 2), QString("started"));
+        QCOMPARE(csv.getValue(3, 2), QString("a,b \"quoted\""));
+        QCOMPARE(csv.getValue(1001, 2), QString::fromUtf8("行\n1000"));
+        QFile::remove("qtcsv_append_test.csv");
+    }
+
+    // ==================== 测试流式行读取 ====================
+    void testCsvReader() {
+        QFile file("qtcsv_reader_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("id,text\r\n");
+        file.write("1,\"a,b\"\r\n");
+        file.write("2,\"say \"\"hi\"\"\nnext\"\n");
+        file.write("3,");
+        file.write(QString::fromUtf8("中文").toUtf8());
+        file.close();
+
+        CsvReader reader("qtcsv_reader_test.csv");
+        QVERIFY(reader.nextRow());
+        QCOMPARE(reader.row().size(), 2);
+        QCOMPARE(reader.row()[1].toString(), QString("text"));
+
+        QStringList seen;
+        for (const CsvReader::Row& row : reader) {
+            QCOMPARE(row.size(), 2);
+            QCOMPARE(row.number(), reader.rowsRead() - 1);
+            seen.append(row[1].toString());
+        }
+        QCOMPARE(seen, QStringList({"a,b", "say \"hi\"\nnext", QString::fromUtf8("中文")}));
+        QVERIFY(reader.atEnd());
+        QVERIFY(reader.row().field(5).isEmpty());
+
+        QVERIFY(reader.rewind());
+        QVERIFY(reader.nextRow());
+        QCOMPARE(reader.row().toStringList(), QStringList({"id", "text"}));
+
+        // operator>> 建立在同一个读取器上，按单元格读出
+        QCsv csv("qtcsv_reader_test.csv");
+        QString value;
+        QStringList cells;
+        while (csv.hasNext()) {
+            csv >> value;
+            if (csv.hasNext()) cells.append(value);
+        }
+        QCOMPARE(cells.size(), 8);
+        QCOMPARE(cells[5], QString("say \"hi\"\nnext"));
+        QCOMPARE(cells[7], QString::fromUtf8("中文"));
+        QFile::remove("qtcsv_reader_test.csv");
+    }
+
+    // ==================== 测试读取后端 ====================
+    void testReaderBackends() {
+        QFile file("qtcsv_backend_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 0; i < 5000; ++i) {
+            file.write(QString::fromUtf8("%1,\"多行\n字段 %1\",%2\r\n").arg(i).arg(QString(i % 50, 'x')).toUtf8());
+        }
+        file.close();
+
+        const CsvReader::IoBackend backends[] = {
+            CsvReader::IoBackend::Buffered,
+            CsvReader::IoBackend::MemoryMap,
+            CsvReader::IoBackend::ReadAhead
+        };
+        for (CsvReader::IoBackend backend : backends) {
+            CsvReader::Options options;
+            options.backend = backend;
+            options.bufferSize = 4096;  // 小块，让字段跨块
+            CsvReader reader("qtcsv_backend_test.csv", ',', options);
+            int rows = 0;
+            for (const CsvReader::Row& row : reader) {
+                QCOMPARE(row.size(), 3);
+                QCOMPARE(row[0].toString(), QString::number(rows));
+                QCOMPARE(row[1].toString(), QString::fromUtf8("多行\n字段 %1").arg(rows));
+                QCOMPARE(row[2].size(), qsizetype(rows % 50));
+                ++rows;
+            }
+            QCOMPARE(rows, 5000);
+            QVERIFY(reader.errorString().isEmpty());
+
+            // 回到开头可再次读取
+            QVERIFY(reader.rewind());
+            QVERIFY(reader.nextRow());
+            QCOMPARE(reader.row()[0].toString(), QString("0"));
+        }
+
+        const CsvReader::IoBackend best = CsvReader::fastestBackend("qtcsv_backend_test.csv");
+        QVERIFY(std::find(std::begin(backends), std::end(backends), best) != std::end(backends));
+        QFile::remove("qtcsv_backend_test.csv");
+    }
+
+    // ==================== 测试行索引定位 ====================
+    void testSeekToRow() {
+        QFile file("qtcsv_seek_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 0; i < 10000; ++i) {
+            file.write(QString("%1,\"v\r\n%1\"\r\n").arg(i).toUtf8());
+        }
+        file.close();
+        QFile::remove("qtcsv_seek_test.csv.idx");
+
+        CsvReader::Options options;
+        options.indexStride = 16;
+        options.persistIndex = true;
+        {
+            CsvReader reader("qtcsv_seek_test.csv", ',', options);
+            QCOMPARE(reader.rowCount(), qint64(-1));
+            QVERIFY(reader.buildIndex());
+            QCOMPARE(reader.rowCount(), qint64(10000));
+            QVERIFY(QFile::exists("qtcsv_seek_test.csv.idx"));
+
+            QVERIFY(reader.seekToRow(7777));
+            QVERIFY(reader.nextRow());
+            QCOMPARE(reader.row().number(), qint64(7777));
+            QCOMPARE(reader.row()[1].toString(), QString("v\r\n7777"));
+
+            // 向回定位
+            QVERIFY(reader.seekToRow(3));
+            QVERIFY(reader.nextRow());
+            QCOMPARE(reader.row()[0].toString(), QString("3"));
+            QVERIFY(reader.seekToRow(10000));
+            QVERIFY(!reader.nextRow());
+            QVERIFY(!reader.seekToRow(10001));
+        }
+
+        // 旁路索引在文件未变化时直接复用
+        {
+            CsvReader reader("qtcsv_seek_test.csv", ',', options);
+            QVERIFY(reader.open());
+            QCOMPARE(reader.rowCount(), qint64(10000));
+            QVERIFY(reader.seekToRow(9999));
+            QVERIFY(reader.nextRow());
+            QCOMPARE(reader.row()[0].toString(), QString("9999"));
+        }
+
+        // QCsv::seekToCell（1-based）
+        QCsv csv("qtcsv_seek_test.csv");
+        QVERIFY(csv.seekToCell(5001, 2));
+        QString value;
+        csv >> value;
+        QCOMPARE(value, QString("v\r\n5000"));
+        csv >> value;
+        QCOMPARE(value, QString("5001"));
+        QVERIFY(!csv.seekToCell(20000, 1));
+
+        // 文件变化后旁路索引作废
+        QVERIFY(file.open(QIODevice::Append));
+        file.write("10000,x\n");
+        file.close();
+        {
+            CsvReader reader("qtcsv_seek_test.csv", ',', options);
+            QVERIFY(reader.open());
+            QCOMPARE(reader.rowCount(), qint64(-1));
+            QVERIFY(reader.seekToRow(10000));
+            QVERIFY(reader.nextRow());
+            QCOMPARE(reader.row()[1].toString(), QString("x"));
+        }
+
+        QFile::remove("qtcsv_seek_test.csv");
+        QFile::remove("qtcsv_seek_test.csv.idx");
+    }
+
+    // ==================== 测试类型化列 ====================
+    void testTypedColumns() {
+        QFile file("qtcsv_typed_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("id,price,active,day,name\n");
+        file.write("1,9.5,true,2024-01-31,apple\n");
+        file.write("2,,FALSE,2024-02-29,pear\n");
+        file.write("3,12,true,,42\n");
+        file.close();
+
+        QCsv csv("qtcsv_typed_test.csv");
+        QCsv::LoadOptions options;
+        options.inferTypes = true;
+        csv.setLoadOptions(options);
+        csv.enableHeaders(true);
+        csv.load();
+
+        QCOMPARE(csv.getColumnType(1), QCsv::ColumnType::Int64);
+        QCOMPARE(csv.getColumnType(2), QCsv::ColumnType::Double);
+        QCOMPARE(csv.getColumnType(3), QCsv::ColumnType::Bool);
+        QCOMPARE(csv.getColumnType(4), QCsv::ColumnType::Date);
+        QCOMPARE(csv.getColumnType(5), QCsv::ColumnType::String);
+
+        QCOMPARE(csv.getInt64(3, 1).value_or(-1), qint64(2));
+        QCOMPARE(csv.getDouble(2, 2).value_or(-1), 9.5);
+        QVERIFY(!csv.getDouble(3, 2).has_value());  // 空单元格
+        QCOMPARE(csv.getBool(3, 3).value_or(true), false);
+        QCOMPARE(csv.getDate(3, 4).value_or(QDate()), QDate(2024, 2, 29));
+        QCOMPARE(csv.getDouble(4, 5).value_or(-1), 42.0);  // 字符串列按单元格解析
+
+        const CsvColumnView<double> prices = csv.columnAsDouble(2);
+        QCOMPARE(prices.size(), qsizetype(4));
+        QVERIFY(prices.isNull(0));  // 表头行
+        QCOMPARE(prices[1], 9.5);
+        QVERIFY(prices.isNull(2));
+        QCOMPARE(prices[3], 12.0);
+        QCOMPARE(csv.columnAsInt64(4)[1], QDate(2024, 1, 31).toJulianDay());
+        QVERIFY(csv.columnAsDouble(5).isEmpty());
+
+        // 并发模式下不给出指向内部数组的视图
+        csv.setConcurrent(true);
+        QVERIFY(csv.columnAsDouble(2).isEmpty());
+        QVERIFY(csv.columnAsInt64(4).isEmpty());
+        QCOMPARE(csv.getDouble(2, 2).value_or(-1), 9.5);
+        csv.setConcurrent(false);
+
+        // 修改同步到类型化数组；新增行扩展数组
+        csv.setValue(3, 2, "1.25");
+        csv.setValue(6, 2, "7");
+        QCOMPARE(csv.columnAsDouble(2)[2], 1.25);
+        QCOMPARE(csv.columnAsDouble(2).size(), qsizetype(6));
+        QCOMPARE(csv.getDouble(6, 2).value_or(-1), 7.0);
+        QVERIFY(!csv.getDouble(5, 2).has_value());
+
+        // 写入不符的值后列退化为字符串
+        csv.setValue(2, 1, "n/a");
+        QCOMPARE(csv.getColumnType(1), QCsv::ColumnType::String);
+        QVERIFY(csv.columnAsInt64(1).isEmpty());
+        QCOMPARE(csv.getInt64(3, 1).value_or(-1), qint64(2));
+        QFile::remove("qtcsv_typed_test.csv");
+    }
+
+    // ==================== 测试列聚合 ====================
+    void testAggregations() {
+        QFile file("qtcsv_aggregate_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("city,amount,note,paid\n");
+        file.write("a,4,x,true\n");
+        file.write("b,1,y,false\n");
+        file.write("a,,x,\n");
+        file.write("b,3,z,TRUE\n");
+        file.write("a,8,,true\n");
+        file.close();
+
+        // 字符串路径与类型化（SIMD）路径结果一致
+        for (bool inferTypes : { false, true }) {
+            QCsv csv("qtcsv_aggregate_test.csv");
+            QCsv::LoadOptions options;
+            options.inferTypes = inferTypes;
+            csv.setLoadOptions(options);
+            csv.enableHeaders(true);
+            csv.load();
+
+            const QCsv::Aggregate total = csv.aggregate(2);
+            QCOMPARE(total.count, qint64(4));
+            QCOMPARE(total.sum, 16.0);
+            QCOMPARE(total.min, 1.0);
+            QCOMPARE(total.max, 8.0);
+            QCOMPARE(total.mean, 4.0);
+            QCOMPARE(total.variance, 6.5);
+            QCOMPARE(csv.sum(2), 16.0);
+            QCOMPARE(csv.max(2).value_or(-1), 8.0);
+            QVERIFY(!csv.mean(3).has_value());  // 没有数值
+
+            QCOMPARE(csv.count(2), qint64(4));
+            QCOMPARE(csv.count(3), qint64(4));
+            QCOMPARE(csv.countDistinct(1), qint64(2));
+            QCOMPARE(csv.countDistinct(3), qint64(3));
+
+            const QHash<QString, QCsv::Aggregate> byCity = csv.aggregateBy(2, 1);
+            QCOMPARE(byCity.size(), 2);
+            QCOMPARE(byCity.value("a").count, qint64(2));
+            QCOMPARE(byCity.value("a").mean, 6.0);
+            QCOMPARE(byCity.value("b").sum, 4.0);
+            QCOMPARE(byCity.value("b").variance, 1.0);
+
+            // 布尔列不是数值，推断为 Bool 时也不按 0/1 聚合
+            QCOMPARE(csv.getColumnType(4), inferTypes ? QCsv::ColumnType::Bool : QCsv::ColumnType::String);
+            QCOMPARE(csv.aggregate(4).count, qint64(0));
+            QCOMPARE(csv.sum(4), 0.0);
+            QVERIFY(!csv.max(4).has_value());
+            QCOMPARE(csv.aggregateBy(4, 1).value("a").count, qint64(0));
+            QVERIFY(!csv.getDouble(2, 4).has_value());
+            QVERIFY(!csv.getInt64(2, 4).has_value());
+            QCOMPARE(csv.getBool(2, 4).value_or(false), true);
+
+            // 追加行写入 Int64 列：类型化数组随之扩展，聚合与区间过滤与字符串路径一致
+            csv.setValue(7, 2, "100");
+            QCOMPARE(csv.getColumnType(2), inferTypes ? QCsv::ColumnType::Int64 : QCsv::ColumnType::String);
+            const QCsv::Aggregate appended = csv.aggregate(2);
+            QCOMPARE(appended.count, qint64(5));
+            QCOMPARE(appended.sum, 116.0);
+            QCOMPARE(appended.max, 100.0);
+            QCOMPARE(csv.findRows(CsvPredicate::range(2, 50, 200)), QList<int>({7}));
+            QCOMPARE(csv.findRows(CsvPredicate::greater(2, 3.5)), QList<int>({2, 6, 7}));
+        }
+        QFile::remove("qtcsv_aggregate_test.csv");
+
+        // 大列分块并行，与单线程结果一致
+        const int rows = 300000;
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 1; i <= rows; ++i) {
+            file.write(QByteArray::number(i % 7 == 0 ? -i : i) + '\n');
+        }
+        file.close();
+        QCsv big("qtcsv_aggregate_test.csv");
+        QCsv::LoadOptions options;
+        options.inferTypes = true;
+        big.setLoadOptions(options);
+        big.load();
+        const QCsv::Aggregate serial = big.aggregate(1);
+        const QCsv::Aggregate parallel = big.aggregate(1, 4);
+        QCOMPARE(serial.count, qint64(rows));
+        QCOMPARE(parallel.count, serial.count);
+        QCOMPARE(parallel.sum, serial.sum);
+        QCOMPARE(parallel.min, double(-(rows / 7 * 7)));
+        QCOMPARE(parallel.max, serial.max);
+        QVERIFY(qAbs(parallel.variance - serial.variance) <= 1e-9 * serial.variance);
+        QFile::remove("qtcsv_aggregate_test.csv");
+    }
+
+    // ==================== 测试数值解析 ====================
+    void testNumberParsing() {
+        QCsv csv("test.csv");
+        QCOMPARE(csv.toDouble("+1.5e3").value_or(0), 1500.0);
+        QCOMPARE(csv.toDouble("\t-0.25 ").value_or(0), -0.25);
+        QVERIFY(!csv.toDouble("1,5").has_value());
+        QVERIFY(!csv.toDouble("+-5").has_value());
+        QVERIFY(!csv.isNumeric("1e400"));  // 溢出
+
+        // 最短表示往返无损
+        const double tricky[] = { 0.1, 1.0 / 3.0, 2.2250738585072014e-308, 9007199254740993.0, 1e23 };
+        for (double value : tricky) {
+            const QString text = QString::number(value, 'g', QLocale::FloatingPointShortest);
+            QCOMPARE(csv.toDouble(text).value_or(0), value);
+        }
+
+        // deferDecode 时类型推断直接解析映射中的字节
+        QFile file("qtcsv_number_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("n,x\n");
+        file.write(" 42 ,0.1\n");
+        file.write("-7,1e23\n");
+        file.close();
+
+        QCsv mapped("qtcsv_number_test.csv");
+        QCsv::LoadOptions options;
+        options.memoryMap = true;
+        options.deferDecode = true;
+        options.inferTypes = true;
+        mapped.setLoadOptions(options);
+        mapped.enableHeaders(true);
+        mapped.load();
+        QCOMPARE(mapped.getColumnType(1), QCsv::ColumnType::Int64);
+        QCOMPARE(mapped.getInt64(2, 1).value_or(0), qint64(42));
+        QCOMPARE(mapped.getDouble(3, 2).value_or(0), 1e23);
+        QCOMPARE(mapped.getValue(2, 1), QString(" 42 "));
+        mapped.close();
+        QFile::remove("qtcsv_number_test.csv");
+    }
+
+    // ==================== 测试过滤 ====================
+    void testFilter() {
+        QFile file("qtcsv_filter_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("city,amount,code,vip\n");
+        file.write("Beijing,12,A-01,true\n");
+        file.write("Shanghai,5,B-02,false\n");
+        file.write("Beijing,,A-03,true\n");
+        file.write("Shenzhen,20,C-04,false\n");
+        file.write("Beijing,7.5,B-05,\n");
+        file.close();
+
+        // 无索引的逐列扫描、搜索索引 + SIMD 类型化列两种路径结果一致
+        for (bool indexed : { false, true }) {
+            QCsv csv("qtcsv_filter_test.csv");
+            QCsv::LoadOptions options;
+            options.buildSearchIndex = false;
+            options.inferTypes = indexed;
+            csv.setLoadOptions(options);
+            csv.enableHeaders(true);
+            csv.load();
+            if (indexed) csv.search("Beijing");  // 建立搜索索引
+
+            QCOMPARE(csv.findRows(CsvPredicate::equals(1, "Beijing")), QList<int>({2, 4, 6}));
+            QCOMPARE(csv.findRows(CsvPredicate::greater(2, 7.5)), QList<int>({2, 5}));
+            QCOMPARE(csv.findRows(CsvPredicate::range(2, 5, 12)), QList<int>({2, 3, 6}));
+            QCOMPARE(csv.findRows(CsvPredicate::equals(1, "Beijing") && CsvPredicate::less(2, 10)), QList<int>({6}));
+            QCOMPARE(csv.findRows(CsvPredicate::in(1, {"Shanghai", "Shenzhen"}) || CsvPredicate::prefix(3, "A-")),
+                     QList<int>({2, 3, 4, 5}));
+            QCOMPARE(csv.findRows(CsvPredicate::contains(3, "b", Qt::CaseInsensitive)), QList<int>({3, 6}));
+            QCOMPARE(csv.findRows(CsvPredicate::regex(3, QRegularExpression("^[AC]-0[34]$"))), QList<int>({4, 5}));
+            QCOMPARE(csv.findRows(CsvPredicate()).size(), 5);  // 空条件匹配所有数据行
+            QVERIFY(csv.findRows(CsvPredicate::range(4, 0, 1)).isEmpty());  // 布尔列不按 0/1 参与数值比较
+
+            const CsvRowSelection selection = csv.filter(CsvPredicate::equals(1, "Beijing"));
+            QCOMPARE(selection.size(), qint64(6));
+            QCOMPARE(selection.count(), qint64(3));
+            QVERIFY(selection.contains(1));
+            QVERIFY(!selection.contains(0));  // 表头行
+        }
+
+        // 流式过滤
+        CsvReader reader("qtcsv_filter_test.csv");
+        const CsvPredicate bigCities = CsvPredicate::greaterEqual(2, 10);
+        QVERIFY(reader.nextMatchingRow(bigCities));
+        QCOMPARE(reader.row().number(), qint64(1));
+        QVERIFY(reader.rewind());
+        const CsvRowSelection streamed = reader.select(bigCities);
+        QCOMPARE(streamed.size(), qint64(6));
+        QCOMPARE(streamed.toRowIds(), std::vector<qint64>({1, 4}));
+        QFile::remove("qtcsv_filter_test.csv");
+    }
+
+    // ==================== 测试列投影 ====================
+    void testProjection() {
+        QFile file("qtcsv_projection_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("id,note,name,score\n");
+        for (int i = 0; i < 2000; ++i) {
+            // 被跳过的列中含分隔符、换行和转义引号
+            file.write(QByteArray::number(i) + ",\"a,b\r\n\"\"" + QByteArray::number(i) + "\"\"\",名字"
+                       + QByteArray::number(i) + "," + QByteArray::number(i % 7) + "\n");
+        }
+        file.close();
+
+        auto loadWith = [](QCsv::LoadOptions options) {
+            auto csv = std::make_unique<QCsv>("qtcsv_projection_test.csv");
+            options.columns = {4};
+            options.columnNames = {"name", "id"};
+            csv->setLoadOptions(options);
+            csv->load();
+            return csv;
+        };
+
+        QCsv::LoadOptions mapped;
+        mapped.memoryMap = true;
+        mapped.deferDecode = true;
+        QCsv::LoadOptions lazy;
+        lazy.lazy = true;
+        lazy.rowCacheSize = 16;
+        for (const QCsv::LoadOptions& options : { QCsv::LoadOptions(), mapped, lazy }) {
+            const auto csv = loadWith(options);
+            QCOMPARE(csv->getRowCount(), 2001);
+            QCOMPARE(csv->getColumnCount(), 3);
+            QCOMPARE(csv->getValue("A1"), QString("score"));
+            QCOMPARE(csv->getValue("B1"), QString("name"));
+            QCOMPARE(csv->getValue("C1"), QString("id"));
+            QCOMPARE(csv->getValue("B1235"), QString("名字1233"));
+            QCOMPARE(csv->getValue("C1235"), QString("1233"));
+            QCOMPARE(csv->getValue("A1235"), QString("1"));
+            QVERIFY(!csv->contains("D2"));
+            QCOMPARE(csv->search("名字42"), QList<QString>{"B44"});
+        }
+
+        // 未加载的列不能被覆盖掉
+        QFile source("qtcsv_projection_test.csv");
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        const QByteArray original = source.readAll();
+        source.close();
+        {
+            const auto csv = loadWith(QCsv::LoadOptions());
+            csv->setValue(2, 1, "9");
+            QVERIFY(!csv->save());
+            QVERIFY(!csv->atomicSave());
+            QVERIFY(!csv->sync().result());
+            QVERIFY(source.open(QIODevice::ReadOnly));
+            QCOMPARE(source.readAll(), original);
+            source.close();
+            QVERIFY(csv->atomicSaveAs("qtcsv_projection_saved.csv"));
+            QFile::remove("qtcsv_projection_saved.csv");
+        }
+
+        QCsv unknown("qtcsv_projection_test.csv");
+        QCsv::LoadOptions options;
+        options.columnNames = {"missing"};
+        unknown.setLoadOptions(options);
+        try {
+            unknown.load();
+            QFAIL("Expected std::invalid_argument not thrown");
+        } catch (const std::invalid_argument& e) {
+            QVERIFY(e.what());
+        }
+        QFile::remove("qtcsv_projection_test.csv");
+    }
+
+    // ==================== 测试行范围与抽样加载 ====================
+    void testRowRange() {
+        QFile file("qtcsv_range_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("id,text\r\n");
+        for (int i = 0; i < 100; ++i) {
+            // 引号内的换行不是行边界
+            file.write(QByteArray::number(i) + ",\"line\r\n\"\"" + QByteArray::number(i) + "\"\"\"\r\n");
+        }
+        file.close();
+
+        auto loadWith = [](const QCsv::LoadOptions& options, bool headers) {
+            auto csv = std::make_unique<QCsv>("qtcsv_range_test.csv");
+            csv->setLoadOptions(options);
+            csv->enableHeaders(headers);
+            csv->load();
+            return csv;
+        };
+
+        QCsv::LoadOptions head;
+        head.startRow = 10;
+        head.rowLimit = 5;
+        auto csv = loadWith(head, true);
+        QCOMPARE(csv->getRowCount(), 6);
+        QCOMPARE(csv->getValue("A1"), QString("id"));
+        QCOMPARE(csv->getValue("A2"), QString("10"));
+        QCOMPARE(csv->getValue("B6"), QString("line\r\n\"14\""));
+
+        // 不启用表头时表头行也按数据行计
+        csv = loadWith(head, false);
+        QCOMPARE(csv->getValue("A1"), QString("9"));
+
+        QCsv::LoadOptions tail;
+        tail.tailRows = 3;
+        tail.memoryMap = true;
+        tail.deferDecode = true;
+        csv = loadWith(tail, true);
+        QCOMPARE(csv->getRowCount(), 4);
+        QCOMPARE(csv->getValue("A1"), QString("id"));
+        QCOMPARE(csv->getValue("A2"), QString("97"));
+        QCOMPARE(csv->getValue("B4"), QString("line\r\n\"99\""));
+
+        // 只加载了部分行，不能覆盖源文件，另存为其它路径不受影响
+        QFile source("qtcsv_range_test.csv");
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        const QByteArray original = source.readAll();
+        source.close();
+        csv->setValue(2, 1, "changed");
+        QVERIFY(!csv->save());
+        QVERIFY(!csv->atomicSave());
+        QVERIFY(!csv->sync().result());
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        QCOMPARE(source.readAll(), original);
+        source.close();
+        QVERIFY(csv->saveAs("qtcsv_range_saved.csv"));
+        QFile::remove("qtcsv_range_saved.csv");
+
+        tail.tailRows = 1000;
+        QCOMPARE(loadWith(tail, true)->getRowCount(), 101);
+
+        QCsv::LoadOptions stride;
+        stride.stride = 10;
+        stride.startRow = 5;
+        csv = loadWith(stride, true);
+        QCOMPARE(csv->getRowCount(), 11);
+        QCOMPARE(csv->getValue("A2"), QString("5"));
+        QCOMPARE(csv->getValue("A11"), QString("95"));
+
+        QCsv::LoadOptions sample;
+        sample.sampleSize = 8;
+        sample.sampleSeed = 42;
+        csv = loadWith(sample, true);
+        QCOMPARE(csv->getRowCount(), 9);
+        int previous = -1;
+        for (int row = 2; row <= 9; ++row) {
+            const int id = csv->getValue(row, 1).toInt();
+            QVERIFY(id > previous);  // 抽样结果保持文件顺序
+            QCOMPARE(csv->getValue(row, 2), QString("line\r\n\"%1\"").arg(id));
+            previous = id;
+        }
+        QCOMPARE(loadWith(sample, true)->getAllValues(), csv->getAllValues());  // 固定种子可复现
+        QFile::remove("qtcsv_range_test.csv");
+    }
+
+    // ==================== 测试运行指标 ====================
+    void testMetrics() {
+        QFile file("qtcsv_metrics_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("a,\"b,1\",c\n");
+        file.write("\"d\",,f\n");
+        file.close();
+
+        QCsv csv("qtcsv_metrics_test.csv");
+        QVERIFY(!csv.metricsEnabled());
+        csv.load();
+        QCOMPARE(csv.metrics().loadNs, qint64(0));  // 未开启时不记录
+        QCOMPARE(csv.metricsTrace(), QByteArray("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[]}"));
+
+        int published = 0;
+        QObject::connect(&csv, &QCsv::metricsReady, [&published](const QCsv::Metrics&) { ++published; });
+        csv.setMetricsEnabled(true);
+        csv.load();
+        QCOMPARE(published, 1);
+
+        const QCsv::Metrics loaded = csv.metrics();
+        QCOMPARE(loaded.bytesRead, file.size());
+        QCOMPARE(loaded.rows, qint64(2));
+        QCOMPARE(loaded.cells, qint64(5));
+        QCOMPARE(loaded.emptyCells, qint64(1));
+        QCOMPARE(loaded.quotedCells, qint64(2));
+        QCOMPARE(loaded.quotedRatio(), 2.0 / 6.0);
+        QVERIFY(loaded.loadNs >= loaded.tokenizeNs + loaded.insertNs);
+        QVERIFY(loaded.allocations > 0);
+        QVERIFY(loaded.indexBuildNs > 0);
+
+        QVERIFY(csv.saveAs("qtcsv_metrics_out.csv"));
+        QCOMPARE(published, 2);
+        const QCsv::Metrics saved = csv.metrics();
+        QCOMPARE(saved.bytesWritten, QFileInfo("qtcsv_metrics_out.csv").size());
+        QVERIFY(saved.saveNs >= saved.savePrepareNs + saved.saveWriteNs + saved.saveCommitNs);
+        QCOMPARE(saved.cells, loaded.cells);  // 保存不影响加载指标
+
+        // Chrome trace：每个阶段一个完整事件
+        const QJsonObject trace = QJsonDocument::fromJson(csv.metricsTrace()).object();
+        QStringList names;
+        for (const QJsonValue& event : trace.value("traceEvents").toArray()) {
+            QCOMPARE(event.toObject().value("ph").toString(), QString("X"));
+            names.append(event.toObject().value("name").toString());
+        }
+        QVERIFY(names.contains("load"));
+        QVERIFY(names.contains("parse"));
+        QVERIFY(names.contains("buildIndex"));
+        QVERIFY(names.contains("write"));
+
+        csv.setMetricsEnabled(false);
+        csv.load();
+        QCOMPARE(published, 2);
+
+        // 事件超过 MAX_TRACE_EVENTS 后覆盖最早的，trace 仍包含最近一次加载
+        QCsv busy("qtcsv_metrics_test.csv");
+        busy.setMetricsEnabled(true);
+        for (int i = 0; i < QCsv::MAX_TRACE_EVENTS / 2; ++i) {
+            busy.load();
+        }
+        const QJsonArray recent = QJsonDocument::fromJson(busy.metricsTrace()).object().value("traceEvents").toArray();
+        QCOMPARE(recent.size(), QCsv::MAX_TRACE_EVENTS);
+        const QJsonObject last = recent.last().toObject();
+        QCOMPARE(last.value("name").toString(), QString("load"));
+        QVERIFY(last.value("ts").toDouble() >= recent.first().toObject().value("ts").toDouble());
+        QFile::remove("qtcsv_metrics_test.csv");
+        QFile::remove("qtcsv_metrics_out.csv");
+    }
+
+    // ==================== 测试字符堆与短值内联 ====================
+    void testArenaStorage() {
+        QFile file("qtcsv_arena_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 1; i <= 10000; ++i) {
+            file.write(QByteArray::number(i % 100) + ",中,é文字" + QByteArray::number(i) + "\n");
+        }
+        file.close();
+
+        QCsv csv("qtcsv_arena_test.csv");
+        QCsv::LoadOptions options;
+        options.buildSearchIndex = false;
+        csv.setLoadOptions(options);
+        csv.setMetricsEnabled(true);
+        csv.load();
+        QCOMPARE(csv.getValue(1, 1), QString("1"));
+        QCOMPARE(csv.getValue(2, 2), QString("中"));  // 3 字节解码为 1 个字符，内联存放
+        QCOMPARE(csv.getValue(10000, 3), QString("é文字10000"));
+        QVERIFY(csv.metrics().allocations < 1000);    // 不再逐单元格分配
+
+        qDebug() << "测试内联值与堆中值互相覆盖...";
+        const QString longValue(70000, QChar('x'));   // 超过一个槽
+        csv.setValue(1, 1, longValue);
+        csv.setValue(1, 2, "abc");
+        QCOMPARE(csv.getValue(1, 1), longValue);
+        csv.setValue(1, 1, "ab");
+        QCOMPARE(csv.getValue(1, 1), QString("ab"));
+        csv.setValue(1, 1, csv.getValue(1, 2));
+        QCOMPARE(csv.getValue(1, 1), QString("abc"));
+
+        qDebug() << "测试压缩与快照...";
+        QCsv::Snapshot snapshot = csv.snapshot();
+        for (int i = 0; i < 5000; ++i) {
+            csv.setValue(2, 3, QString(3 + i % 40, QChar('a' + i % 26)));
+        }
+        QCOMPARE(csv.getValue(2, 3), QString(42, QChar('h')));
+        QCOMPARE(csv.getValue(3, 3), QString("é文字3"));
+        QCOMPARE(snapshot.getValue(2, 3), QString("é文字2"));
+        QCOMPARE(snapshot.getValue(1, 1), QString("abc"));
+
+        csv.close();
+        QCOMPARE(csv.size(), 0);
+        QFile::remove("qtcsv_arena_test.csv");
+    }
+
+    // ==================== 测试 UTF-8 存储 ====================
+    void testUtf8Storage() {
+        QFile file("qtcsv_utf8_test.csv");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int i = 1; i <= 5000; ++i) {
+            file.write(QByteArray::number(i) + ",é文字" + QByteArray::number(i) + ",\"a,\"\"b\"\"\",ab\n");
+        }
+        file.close();
+
+        QCsv plain("qtcsv_utf8_test.csv");
+        plain.load();
+
+        // 普通加载、内存映射延迟解码两种路径
+        for (bool memoryMap : { false, true }) {
+            QCsv csv("qtcsv_utf8_test.csv");
+            QCsv::LoadOptions options;
+            options.utf8Storage = true;
+            options.memoryMap = memoryMap;
+            options.deferDecode = memoryMap;
+            options.searchIndexKind = QCsv::SearchIndexKind::Sorted;
+            csv.setLoadOptions(options);
+            csv.load();
+
+            QCOMPARE(csv.getValue(12, 2), QString("é文字12"));
+            QCOMPARE(csv.getValue(12, 3), QString("a,\"b\""));
+            QCOMPARE(csv.getValue(12, 4), QString("ab"));   // 内联
+            QCOMPARE(csv.getValueUtf8(12, 2), QString("é文字12").toUtf8());
+            QCOMPARE(csv.getValueView(12, 2)->toString(), QString("é文字12"));
+            QVERIFY(csv.getValueView(12, 5).has_value() && csv.getValueView(12, 5)->isEmpty());  // 空单元格
+            QCOMPARE(csv.getAllValues(), plain.getAllValues());
+            QCOMPARE(csv.search("é文字7"), QList<QString>{"B7"});
+            QCOMPARE(csv.searchByPrefix("é文字499").size(), 11);
+            QCOMPARE(csv.sum(1), 5000.0 * 5001 / 2);
+
+            qDebug() << "测试 UTF-8 存储的修改与快照...";
+            QCsv::Snapshot snapshot = csv.snapshot();
+            csv.setValue(1, 2, "中文字段");
+            csv.setValue(2, 2, QString(300, QChar(0x4E2D)));
+            QCOMPARE(csv.getValue(1, 2), QString("中文字段"));
+            QCOMPARE(csv.getValue(2, 2), QString(300, QChar(0x4E2D)));
+            QCOMPARE(csv.search("中文字段"), QList<QString>{"B1"});
+            QCOMPARE(snapshot.getValue(1, 2), QString("é文字1"));
+
+            // 保存直接写出 UTF-8 字节，按普通模式重新读入一致
+            QVERIFY(csv.saveAs("qtcsv_utf8_saved.csv"));
+            QCsv reloaded("qtcsv_utf8_saved.csv");
+            reloaded.load();
+            QCOMPARE(reloaded.getAllValues(), csv.getAllValues());
+            QCOMPARE(reloaded.getValue(3, 3), QString("a,\"b\""));
+        }
+
+        QFile::remove("qtcsv_utf8_test.csv");
+        QFile::remove("qtcsv_utf8_saved.csv");
+    }
+
     // ==================== 测试边界情况 ====================
     void testEdgeCases() {
         QCsv csv("test.csv");